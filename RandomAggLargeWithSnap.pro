@@ -13,6 +13,9 @@ CONFIG   += console
 CONFIG   += c++11
 CONFIG   -= app_bundle
 
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -fopenmp
+
 QMAKE_LFLAGS_WINDOWS += -Wl,--stack,100000000
 
 TEMPLATE = app
@@ -23,6 +26,18 @@ SOURCES += main.cpp \
     vertex.cpp \
     edge.cpp \
     mygraph.cpp \
+    rng.cpp \
+    bucketqueue.cpp \
+    disjointset.cpp \
+    csrgraph.cpp \
+    fenwicksampler.cpp \
+    contingencytable.cpp \
+    overlapscore.cpp \
+    clusterstats.cpp \
+    modularitytracker.cpp \
+    paircounttracker.cpp \
+    louvain.cpp \
+    labelpropagation.cpp \
     include/snap/glib-core/app.cpp \
     include/snap/glib-core/base.cpp \
     include/snap/glib-core/bd.cpp \
@@ -91,6 +106,19 @@ HEADERS += \
     vertex.h \
     edge.h \
     mygraph.h \
+    rng.h \
+    bucketqueue.h \
+    disjointset.h \
+    csrgraph.h \
+    fenwicksampler.h \
+    aggregator.h \
+    contingencytable.h \
+    overlapscore.h \
+    clusterstats.h \
+    modularitytracker.h \
+    paircounttracker.h \
+    louvain.h \
+    labelpropagation.h \
     include/snap/glib-core/app.h \
     include/snap/glib-core/base.h \
     include/snap/glib-core/bd.h \
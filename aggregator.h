@@ -0,0 +1,456 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <QList>
+#include <QPair>
+#include <vector>
+
+#include "vertex.h"
+#include "edge.h"
+#include "rng.h"
+#include "bucketqueue.h"
+#include "fenwicksampler.h"
+
+/** The random aggregation loop, assembled at compile time from four policies:
+ *  Candidate: which player is drawn next and how the players change after an absorption
+ *  Neighbour: which edge of the candidate is used
+ *  Winner:    which end of that edge absorbs the other
+ *  Mode:      Destructive (loser loses its edges) or Retentive (edges are kept)
+ * Every policy is a class with static or inline members, so each combination
+ * compiles to its own loop with no runtime dispatch.
+ * Vertices folded before the run (Vertex::is_vertex_dragged_along) never play.
+ * Hierarchy pairs are always (loser, winner).
+ */
+namespace AggPolicy
+{
+
+// ------------------------------------- CANDIDATE ---------------------------------------
+
+/** Players drawn u.a.r. Swap-and-pop list with positions, so removal is O(1)
+ */
+class UniformCandidate
+{
+public:
+    void reset(const QList<Vertex*> &V)
+    {
+        myV = &V;
+        myPlayers.clear();
+        myPos.assign(V.size(), NOT_PLAYING);
+        for (int i = 0; i < V.size(); i++)
+        {
+            if (V.at(i)->is_vertex_dragged_along())
+                continue;
+            myPos[i] = myPlayers.size();
+            myPlayers.push_back(i);
+        }
+    }
+    bool empty() const { return myPlayers.empty(); }
+    Vertex * draw(RngBuffer &rng) const { return myV->at(myPlayers[rng.bounded(myPlayers.size())]); }
+    void remove(Vertex * v)
+    {
+        quint32 i = v->getIndex();
+        if (myPos[i] == NOT_PLAYING)
+            return;
+        quint32 p = myPos[i], last = myPlayers.back();
+        myPlayers[p] = last;
+        myPos[last] = p;
+        myPlayers.pop_back();
+        myPos[i] = NOT_PLAYING;
+    }
+    void beforeAbsorb(Vertex *) {}
+    void afterAbsorb(Vertex *, Vertex * loser) { remove(loser); }
+    void finish(QList<Vertex*> &) {}
+
+private:
+    enum { NOT_PLAYING = 0xFFFFFFFFu };
+
+    const QList<Vertex*> * myV;
+    std::vector<quint32> myPlayers;
+    std::vector<quint32> myPos;
+};
+
+/** Uniform among the players of highest current degree (II.g)
+ */
+class MaxDegreeCandidate
+{
+public:
+    void reset(const QList<Vertex*> &V)
+    {
+        myV = &V;
+        myPlayers.reset(V.size());
+        for (int i = 0; i < V.size(); i++)
+            if (!V.at(i)->is_vertex_dragged_along())
+                myPlayers.insert(V.at(i)->getIndex(), V.at(i)->getNumberEdge());
+    }
+    bool empty() const { return myPlayers.empty(); }
+    Vertex * draw(RngBuffer &rng) const { return myV->at(myPlayers.randomMax(rng)); }
+    void remove(Vertex * v) { myPlayers.remove(v->getIndex()); }
+    //every neighbour of the loser loses one edge
+    void beforeAbsorb(Vertex * loser) { myAffected = loser->getNeighbourIndexes(); }
+    void afterAbsorb(Vertex *, Vertex * loser)
+    {
+        myPlayers.remove(loser->getIndex());
+        foreach (quint32 index, myAffected)
+        {
+            if (myPlayers.contains(index))
+                myPlayers.update(index, myV->at(index)->getNumberEdge());
+        }
+    }
+    void finish(QList<Vertex*> &) {}
+
+private:
+    const QList<Vertex*> * myV;
+    BucketQueue myPlayers;
+    QList<quint32> myAffected;
+};
+
+/** Uniform among the players of highest weight, weights start at the degree (II.h)
+ */
+class MaxWeightCandidate
+{
+public:
+    void reset(const QList<Vertex*> &V)
+    {
+        myV = &V;
+        myPlayers.reset(V.size());
+        for (int i = 0; i < V.size(); i++)
+        {
+            Vertex * v = V.at(i);
+            v->setWeight(v->getNumberEdge());
+            if (!v->is_vertex_dragged_along())
+                myPlayers.insert(v->getIndex(), v->getWeight());
+        }
+    }
+    bool empty() const { return myPlayers.empty(); }
+    Vertex * draw(RngBuffer &rng) const { return myV->at(myPlayers.randomMax(rng)); }
+    void remove(Vertex * v) { myPlayers.remove(v->getIndex()); }
+    void beforeAbsorb(Vertex *) {}
+    void afterAbsorb(Vertex * winner, Vertex * loser)
+    {
+        myPlayers.remove(loser->getIndex());
+        myPlayers.update(winner->getIndex(), winner->getWeight());
+    }
+    void finish(QList<Vertex*> &) {}
+
+private:
+    const QList<Vertex*> * myV;
+    BucketQueue myPlayers;
+};
+
+/** Players drawn proportional to their current degree (II.e).
+ * Isolated players are never drawn: they are all winners once no edge is left
+ */
+class DegreeProportionalCandidate
+{
+public:
+    void reset(const QList<Vertex*> &V)
+    {
+        myV = &V;
+        myPlayers.reset(V.size());
+        myPlaying.resize(V.size());
+        for (int i = 0; i < V.size(); i++)
+        {
+            myPlaying[i] = !V.at(i)->is_vertex_dragged_along();
+            myPlayers.set(V.at(i)->getIndex(), V.at(i)->getNumberEdge());
+        }
+    }
+    bool empty() const { return myPlayers.total() == 0; }
+    Vertex * draw(RngBuffer &rng) const { return myV->at(myPlayers.sample(rng)); }
+    void remove(Vertex * v)
+    {
+        myPlaying[v->getIndex()] = false;
+        myPlayers.remove(v->getIndex());
+    }
+    //every neighbour of the loser loses one edge
+    void beforeAbsorb(Vertex * loser) { myAffected = loser->getNeighbourIndexes(); }
+    void afterAbsorb(Vertex *, Vertex * loser)
+    {
+        remove(loser);
+        foreach (quint32 index, myAffected)
+        {
+            if (myPlaying[index])
+                myPlayers.set(index, myV->at(index)->getNumberEdge());
+        }
+    }
+    void finish(QList<Vertex*> &winners)
+    {
+        for (int i = 0; i < myV->size(); i++)
+            if (myPlaying[myV->at(i)->getIndex()])  winners.append(myV->at(i));
+    }
+
+private:
+    const QList<Vertex*> * myV;
+    FenwickSampler myPlayers;
+    std::vector<bool> myPlaying;
+    QList<quint32> myAffected;
+};
+
+/** Players drawn proportional to their weight, weights start at the degree (II.f)
+ */
+class WeightProportionalCandidate
+{
+public:
+    void reset(const QList<Vertex*> &V)
+    {
+        myV = &V;
+        myPlayers.reset(V.size());
+        myPlaying.resize(V.size());
+        for (int i = 0; i < V.size(); i++)
+        {
+            Vertex * v = V.at(i);
+            v->setWeight(v->getNumberEdge());
+            myPlaying[i] = !v->is_vertex_dragged_along();
+            myPlayers.set(v->getIndex(), v->getWeight());
+        }
+    }
+    bool empty() const { return myPlayers.total() == 0; }
+    Vertex * draw(RngBuffer &rng) const { return myV->at(myPlayers.sample(rng)); }
+    void remove(Vertex * v)
+    {
+        myPlaying[v->getIndex()] = false;
+        myPlayers.remove(v->getIndex());
+    }
+    void beforeAbsorb(Vertex *) {}
+    void afterAbsorb(Vertex * winner, Vertex * loser)
+    {
+        remove(loser);
+        myPlayers.set(winner->getIndex(), winner->getWeight());
+    }
+    //only zero weight (isolated) players are left
+    void finish(QList<Vertex*> &winners)
+    {
+        for (int i = 0; i < myV->size(); i++)
+            if (myPlaying[myV->at(i)->getIndex()])  winners.append(myV->at(i));
+    }
+
+private:
+    const QList<Vertex*> * myV;
+    FenwickSampler myPlayers;
+    std::vector<bool> myPlaying;
+};
+
+// ------------------------------------- NEIGHBOUR ---------------------------------------
+// KEY is the neighbour key every vertex tracks during the run (see Vertex::trackNeighbours)
+// TRIANGLES marks the selectors that count triangles, they skip the vertices of core <= 1
+
+struct UniformNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &rng) { return v->getEdge(rng.bounded(v->getNumberEdge())); }
+};
+
+/** Pr(u) = d0(u) / sum d0(i), d0 the initial degree kept as weight (II.a)
+ */
+struct InitialDegreeBiasedNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &V)
+    {
+        for (int i = 0; i < V.size(); i++)
+            V.at(i)->setWeight(V.at(i)->getNumberEdge());
+    }
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getEdgeFromVertex(v->aggregate_get_degree_biased_neighbour()); }
+};
+
+struct CurrentDegreeBiasedNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getDegreeProbabilisticEdge(); }
+};
+
+struct MaxDegreeNeighbour
+{
+    static const int KEY = Vertex::DEGREE_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getHighestDegreeNeighbour(); }
+};
+
+struct MinDegreeNeighbour
+{
+    static const int KEY = Vertex::DEGREE_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getSmallestCurrentDegreeNeighbour(); }
+};
+
+struct MinWeightNeighbour
+{
+    static const int KEY = Vertex::WEIGHT_KEY;
+    static const bool TRIANGLES = false;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getSmallestCurrentWeightNeighbour(); }
+};
+
+struct MostMutualNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = true;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getMostMutualVertex(); }
+};
+
+struct TriangleBiasedNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = true;
+    static void prepare(const QList<Vertex*> &) {}
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getProbabilisticTriangulationCoeffVertex(); }
+};
+
+/** f(u) = tri(u) * weight, weights start at 1 (III.d). May return 0
+ */
+struct TriangleTimesWeightNeighbour
+{
+    static const int KEY = Vertex::NO_KEY;
+    static const bool TRIANGLES = true;
+    static void prepare(const QList<Vertex*> &V)
+    {
+        for (int i = 0; i < V.size(); i++)
+            V.at(i)->setWeight(1);
+    }
+    static Edge * select(Vertex * v, RngBuffer &) { return v->getProbabilisticTriangulationAndWeightVertex(); }
+};
+
+// -------------------------------------- WINNER -----------------------------------------
+
+struct SelectedWins
+{
+    static void prepare(const QList<Vertex*> &) {}
+    static bool selectedWins(Vertex *, Vertex *) { return true; }
+    static void afterAbsorb(Vertex *, Vertex *) {}
+};
+
+/** The winner also takes the loser's weight (II.f, II.h)
+ */
+struct SelectedWinsAndGainsWeight
+{
+    static void prepare(const QList<Vertex*> &) {}
+    static bool selectedWins(Vertex *, Vertex *) { return true; }
+    static void afterAbsorb(Vertex * winner, Vertex * loser) { winner->setWeight(loser->getWeight() + winner->getWeight()); }
+};
+
+struct NeighbourWins
+{
+    static void prepare(const QList<Vertex*> &) {}
+    static bool selectedWins(Vertex *, Vertex *) { return false; }
+    static void afterAbsorb(Vertex *, Vertex *) {}
+};
+
+/** Higher current degree wins, ties to the selected vertex
+ */
+struct HigherDegreeWins
+{
+    static void prepare(const QList<Vertex*> &) {}
+    static bool selectedWins(Vertex * v, Vertex * u) { return v->getNumberEdge() >= u->getNumberEdge(); }
+    static void afterAbsorb(Vertex *, Vertex *) {}
+};
+
+/** Lower current degree wins, ties to the selected vertex (I.x)
+ */
+struct LowerDegreeWins
+{
+    static void prepare(const QList<Vertex*> &) {}
+    static bool selectedWins(Vertex * v, Vertex * u) { return v->getNumberEdge() <= u->getNumberEdge(); }
+    static void afterAbsorb(Vertex *, Vertex *) {}
+};
+
+/** Higher weight wins, ties to the selected vertex. Weights start at the degree
+ */
+struct HigherWeightWins
+{
+    static void prepare(const QList<Vertex*> &V)
+    {
+        for (int i = 0; i < V.size(); i++)
+            V.at(i)->setWeight(V.at(i)->getNumberEdge());
+    }
+    static bool selectedWins(Vertex * v, Vertex * u) { return v->getWeight() >= u->getWeight(); }
+    static void afterAbsorb(Vertex *, Vertex *) {}
+};
+
+// --------------------------------------- MODE ------------------------------------------
+
+/** The loser drops all its edges; isolated players become winners (centroids)
+ */
+struct Destructive
+{
+    static const bool RETAIN = false;
+    static void absorb(Vertex * winner, Edge * e) { winner->absorb_removeEdge(e); }
+};
+
+/** Edges are kept, the loser only points to the winner; isolated players are their own parent
+ */
+struct Retentive
+{
+    static const bool RETAIN = true;
+    static void absorb(Vertex * winner, Edge * e) { winner->absorb_retainEdge(e); }
+};
+
+}
+
+template <class CandidatePolicy, class NeighbourPolicy, class WinnerPolicy, class Mode>
+class Aggregator
+{
+public:
+    typedef NeighbourPolicy NeighbourRule;
+    typedef Mode ModePolicy;
+
+    /** Aggregate V until no player is left
+     * @brief Aggregator::run
+     * @param V every vertex, index == position
+     * @param hierarchy (loser, winner) per absorption
+     * @param winners vertices left unabsorbed (destructive mode)
+     */
+    static void run(const QList<Vertex*> &V, QList<QPair<quint32,quint32> > &hierarchy, QList<Vertex*> &winners)
+    {
+        RngBuffer &rng = Rng::global();
+        NeighbourPolicy::prepare(V);
+        WinnerPolicy::prepare(V);
+        CandidatePolicy players;
+        players.reset(V);
+        const int key = NeighbourPolicy::KEY;
+        if (key != Vertex::NO_KEY)
+            for (int i = 0; i < V.size(); i++)  V.at(i)->trackNeighbours(key);
+
+        while (!players.empty())
+        {
+            Vertex * selected = players.draw(rng);
+            Edge * e = selected->getNumberEdge() == 0 ? 0 : NeighbourPolicy::select(selected, rng);
+            if (e == 0) // if there is no neighbour, declare a winner
+            {
+                if (Mode::RETAIN)
+                {
+                    selected->setParent(selected);
+                    hierarchy.append(qMakePair(selected->getIndex(), selected->getIndex()));
+                }
+                else
+                    winners.append(selected);
+                players.remove(selected);
+                continue;
+            }
+            Vertex * neighbour = selected->get_neighbour_fromEdge(e);
+            Vertex * winner = selected, * loser = neighbour;
+            if (!WinnerPolicy::selectedWins(selected, neighbour))
+            {
+                winner = neighbour;
+                loser = selected;
+            }
+            players.beforeAbsorb(loser);
+            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
+            Mode::absorb(winner, e);
+            WinnerPolicy::afterAbsorb(winner, loser);
+            players.afterAbsorb(winner, loser);
+        }
+        players.finish(winners);
+
+        if (key != Vertex::NO_KEY)
+            for (int i = 0; i < V.size(); i++)  V.at(i)->untrackNeighbours();
+    }
+};
+
+#endif // AGGREGATOR_H
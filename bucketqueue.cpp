@@ -0,0 +1,111 @@
+#include "bucketqueue.h"
+
+#include <QDebug>
+
+const quint32 BucketQueue::NOT_QUEUED;
+
+BucketQueue::BucketQueue()
+{
+    mySize = 0;
+}
+
+BucketQueue::BucketQueue(const quint32 &capacity)
+{
+    reset(capacity);
+}
+
+void BucketQueue::reset(const quint32 &capacity)
+{
+    myBuckets.clear();
+    myKey.assign(capacity, 0);
+    myPos.assign(capacity, NOT_QUEUED);
+    mySize = 0;
+}
+
+void BucketQueue::insert(const quint32 &item, const quint64 &key)
+{
+    if (item >= myPos.size())
+    {
+        qDebug() << "BUCKET QUEUE: ITEM OUT OF RANGE" << item;
+        return;
+    }
+    if (myPos[item] != NOT_QUEUED)
+    {
+        update(item, key);
+        return;
+    }
+    std::vector<quint32> &bucket = myBuckets[key];
+    myKey[item] = key;
+    myPos[item] = bucket.size();
+    bucket.push_back(item);
+    mySize++;
+}
+
+/** Move an item to another bucket: O(log #distinct keys)
+ * @brief BucketQueue::update
+ * @param item
+ * @param key
+ */
+void BucketQueue::update(const quint32 &item, const quint64 &key)
+{
+    if (!contains(item))
+    {
+        insert(item, key);
+        return;
+    }
+    if (myKey[item] == key)
+        return;
+    remove(item);
+    insert(item, key);
+}
+
+/** Swap-with-last removal inside the bucket; empty buckets are dropped
+ * @brief BucketQueue::remove
+ * @param item
+ */
+void BucketQueue::remove(const quint32 &item)
+{
+    if (!contains(item))
+        return;
+    std::map<quint64, std::vector<quint32> >::iterator it = myBuckets.find(myKey[item]);
+    std::vector<quint32> &bucket = it->second;
+    quint32 pos = myPos[item];
+    quint32 last = bucket.back();
+    bucket[pos] = last;
+    myPos[last] = pos;
+    bucket.pop_back();
+    myPos[item] = NOT_QUEUED;
+    if (bucket.empty())
+        myBuckets.erase(it);
+    mySize--;
+}
+
+bool BucketQueue::contains(const quint32 &item) const
+{
+    return item < myPos.size() && myPos[item] != NOT_QUEUED;
+}
+
+quint64 BucketQueue::getKey(const quint32 &item) const
+{
+    return myKey[item];
+}
+
+bool BucketQueue::empty() const
+{
+    return mySize == 0;
+}
+
+quint32 BucketQueue::size() const
+{
+    return mySize;
+}
+
+quint64 BucketQueue::maxKey() const
+{
+    return myBuckets.rbegin()->first;
+}
+
+quint64 BucketQueue::minKey() const
+{
+    return myBuckets.begin()->first;
+}
@@ -0,0 +1,55 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include <QtGlobal>
+#include <map>
+#include <vector>
+
+/** Addressable bucket queue over dense item ids [0, capacity).
+ * Items sharing a key live in one bucket, so the arg-max (arg-min) set is a
+ * bucket and a uniform tie-break is a single bounded draw. Only non-empty
+ * buckets are kept, so sparse keys such as accumulated weights are fine.
+ */
+class BucketQueue
+{
+public:
+    BucketQueue();
+    BucketQueue(const quint32 &capacity);
+
+    void reset(const quint32 &capacity);
+    void insert(const quint32 &item, const quint64 &key);
+    void update(const quint32 &item, const quint64 &key);
+    void remove(const quint32 &item);
+
+    bool contains(const quint32 &item) const;
+    quint64 getKey(const quint32 &item) const;
+    bool empty() const;
+    quint32 size() const;
+
+    quint64 maxKey() const;
+    quint64 minKey() const;
+
+    template <typename G>
+    quint32 randomMax(G &rng) const
+    {
+        const std::vector<quint32> &top = myBuckets.rbegin()->second;
+        return top[rng.bounded(top.size())];
+    }
+
+    template <typename G>
+    quint32 randomMin(G &rng) const
+    {
+        const std::vector<quint32> &bottom = myBuckets.begin()->second;
+        return bottom[rng.bounded(bottom.size())];
+    }
+
+private:
+    static const quint32 NOT_QUEUED = 0xFFFFFFFF;
+
+    std::map<quint64, std::vector<quint32> > myBuckets;
+    std::vector<quint64> myKey;
+    std::vector<quint32> myPos;
+    quint32 mySize;
+};
+
+#endif // BUCKETQUEUE_H
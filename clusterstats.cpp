@@ -0,0 +1,211 @@
+#include "clusterstats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QFile>
+#include <QTextStream>
+#include <QDataStream>
+#include <QDebug>
+
+ClusterStats::ClusterStats()
+{
+    myEdges = 0;
+}
+
+/**
+ * @brief ClusterStats::reset
+ * @param clusters number of clusters
+ * @param edges number of edges of the graph, m
+ */
+void ClusterStats::reset(const quint32 &clusters, const quint64 &edges)
+{
+    myEdges = edges;
+    mySize.assign(clusters, 0);
+    myInternalArcs.assign(clusters, 0);
+    myCut.assign(clusters, 0);
+}
+
+quint32 ClusterStats::getNumberOfClusters() const
+{
+    return mySize.size();
+}
+
+quint32 ClusterStats::size(const quint32 &c) const
+{
+    return mySize[c];
+}
+
+quint64 ClusterStats::internalEdges(const quint32 &c) const
+{
+    return myInternalArcs[c]/2;
+}
+
+quint64 ClusterStats::cutEdges(const quint32 &c) const
+{
+    return myCut[c];
+}
+
+/** Sum of the degrees of the members
+ * @brief ClusterStats::volume
+ * @param c
+ * @return
+ */
+quint64 ClusterStats::volume(const quint32 &c) const
+{
+    return myInternalArcs[c] + myCut[c];
+}
+
+/** cut / min(vol, 2m - vol), 0 if either side has no edge
+ * @brief ClusterStats::conductance
+ * @param c
+ * @return
+ */
+double ClusterStats::conductance(const quint32 &c) const
+{
+    quint64 vol = volume(c), m2 = 2*myEdges;
+    quint64 denom = qMin(vol, m2 > vol ? m2 - vol : 0);
+    if (denom == 0)
+        return 0.0;
+    return (double) myCut[c] / denom;
+}
+
+/** internal edges / (size choose 2), 0 for a singleton
+ * @brief ClusterStats::density
+ * @param c
+ * @return
+ */
+double ClusterStats::density(const quint32 &c) const
+{
+    double s = mySize[c];
+    if (s < 2)
+        return 0.0;
+    return internalEdges(c) / (s * (s - 1) / 2.0);
+}
+
+/** Q = sum internal/m - (vol/2m)^2
+ * @brief ClusterStats::modularity
+ * @return
+ */
+double ClusterStats::modularity() const
+{
+    if (myEdges == 0)
+        return 0.0;
+    double Q = 0.0, m = myEdges;
+    qint64 clusters = mySize.size();
+    #pragma omp parallel for reduction(+:Q)
+    for (qint64 c = 0; c < clusters; c++)
+    {
+        double e = (double) myInternalArcs[c] / (2*m);
+        double a = (double) volume(c) / (2*m);
+        Q += e - a*a;
+    }
+    return Q;
+}
+
+/** One line per cluster:
+ * cluster, size, internal, cut, volume, conductance, density
+ * @brief ClusterStats::writeCSV
+ * @param path
+ * @return false if the file cannot be opened
+ */
+bool ClusterStats::writeCSV(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDebug() << "- Cannot Write Cluster Statistics:" << path;
+        return false;
+    }
+    QTextStream out(&file);
+    out << "cluster,size,internal,cut,volume,conductance,density\n";
+    for (quint32 c = 0; c < getNumberOfClusters(); c++)
+    {
+        out << c << ',' << size(c) << ',' << internalEdges(c) << ',' << cutEdges(c) << ','
+            << volume(c) << ',' << conductance(c) << ',' << density(c) << '\n';
+    }
+    file.close();
+    return true;
+}
+
+/** Columnar, host byte order: quint64 number of clusters k, quint64 m, then the
+ * columns one after another: size (k x quint32), internal, cut, volume
+ * (k x quint64 each), conductance, density (k x double each)
+ * @brief ClusterStats::writeBinary
+ * @param path
+ * @return false if the file cannot be opened
+ */
+bool ClusterStats::writeBinary(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "- Cannot Write Cluster Statistics:" << path;
+        return false;
+    }
+    QDataStream out(&file);
+    quint64 k = getNumberOfClusters();
+    std::vector<quint64> internal(k), volumes(k);
+    std::vector<double> phi(k), rho(k);
+    for (quint64 c = 0; c < k; c++)
+    {
+        internal[c] = internalEdges(c);
+        volumes[c] = volume(c);
+        phi[c] = conductance(c);
+        rho[c] = density(c);
+    }
+    out.writeRawData((const char*) &k, sizeof(quint64));
+    out.writeRawData((const char*) &myEdges, sizeof(quint64));
+    if (k > 0)
+    {
+        out.writeRawData((const char*) &mySize[0], k*sizeof(quint32));
+        out.writeRawData((const char*) &internal[0], k*sizeof(quint64));
+        out.writeRawData((const char*) &myCut[0], k*sizeof(quint64));
+        out.writeRawData((const char*) &volumes[0], k*sizeof(quint64));
+        out.writeRawData((const char*) &phi[0], k*sizeof(double));
+        out.writeRawData((const char*) &rho[0], k*sizeof(double));
+    }
+    file.close();
+    return true;
+}
+
+/** min, median, mean and max of a column
+ * @brief ClusterStats::summarise
+ * @param values reordered
+ * @param name
+ */
+void ClusterStats::summarise(std::vector<double> &values, const char *name)
+{
+    if (values.empty())
+        return;
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); i++)
+        sum += values[i];
+    std::nth_element(values.begin(), values.begin() + values.size()/2, values.end());
+    double median = values[values.size()/2];
+    printf("%s\tmin: %f\tmedian: %f\tmean: %f\tmax: %f\n", name,
+           *std::min_element(values.begin(), values.end()), median,
+           sum / values.size(), *std::max_element(values.begin(), values.end()));
+}
+
+/** Distributions of size, conductance and density, the fraction of edges cut and Q
+ * @brief ClusterStats::printSummary
+ */
+void ClusterStats::printSummary() const
+{
+    quint32 k = getNumberOfClusters();
+    std::vector<double> sizes(k), phi(k), rho(k);
+    quint64 cut = 0;
+    for (quint32 c = 0; c < k; c++)
+    {
+        sizes[c] = size(c);
+        phi[c] = conductance(c);
+        rho[c] = density(c);
+        cut += myCut[c];
+    }
+    printf("Clusters: %u\tCut Edges: %f\tQ: %f\n", k,
+           myEdges == 0 ? 0.0 : (double) cut / 2 / myEdges, modularity());
+    summarise(sizes, "Size");
+    summarise(phi, "Conductance");
+    summarise(rho, "Density");
+}
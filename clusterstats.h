@@ -0,0 +1,54 @@
+#ifndef CLUSTERSTATS_H
+#define CLUSTERSTATS_H
+
+#include <QString>
+#include <vector>
+
+/** Per-cluster statistics of a partition, one column per quantity: size,
+ * internal edges, cut edges, volume, conductance and internal density.
+ * The columns are filled by a single pass over the adjacency of the clustered
+ * vertices (see Graph::count_cluster_statistics), which is also all the
+ * modularity needs, so every measure here costs that one scan.
+ */
+class ClusterStats
+{
+public:
+    ClusterStats();
+
+    void reset(const quint32 &clusters, const quint64 &edges);
+    inline void setSize(const quint32 &c, const quint32 &size) { mySize[c] = size; }
+    /** k ends of edges inside cluster c, each internal edge is seen twice */
+    inline void addInternalArcs(const quint32 &c, const quint64 &k)
+    {
+        #pragma omp atomic
+        myInternalArcs[c] += k;
+    }
+    inline void addCutArcs(const quint32 &c, const quint64 &k)
+    {
+        #pragma omp atomic
+        myCut[c] += k;
+    }
+
+    quint32 getNumberOfClusters() const;
+    quint32 size(const quint32 &c) const;
+    quint64 internalEdges(const quint32 &c) const;
+    quint64 cutEdges(const quint32 &c) const;
+    quint64 volume(const quint32 &c) const;
+    double conductance(const quint32 &c) const;
+    double density(const quint32 &c) const;
+    double modularity() const;
+
+    bool writeCSV(const QString &path) const;
+    bool writeBinary(const QString &path) const;
+    void printSummary() const;
+
+private:
+    static void summarise(std::vector<double> &values, const char *name);
+
+    quint64 myEdges;
+    std::vector<quint32> mySize;
+    std::vector<quint64> myInternalArcs;
+    std::vector<quint64> myCut;
+};
+
+#endif // CLUSTERSTATS_H
@@ -0,0 +1,244 @@
+#include "contingencytable.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+
+const quint32 ContingencyTable::NO_LABEL;
+
+ContingencyTable::ContingencyTable()
+{
+    myTotal = 0;
+}
+
+/** One pass over the vertices: they are bucketed by column (counting sort),
+ * then every column sorts the rows of its own vertices and run-length
+ * encodes them into cells, columns in parallel. O(n log(max column size))
+ * A vertex is counted only if it has a label on both sides
+ * @brief ContingencyTable::build
+ * @param rowOf row label of every vertex, NO_LABEL if none
+ * @param rows row labels are in [0, rows)
+ * @param columnOf column label of every vertex, NO_LABEL if none
+ * @param columns column labels are in [0, columns)
+ */
+void ContingencyTable::build(const std::vector<quint32> &rowOf, const quint32 &rows,
+                             const std::vector<quint32> &columnOf, const quint32 &columns)
+{
+    clear();
+    if (rowOf.size() != columnOf.size())
+    {
+        qDebug() << "CONTINGENCY: LABELLINGS OF DIFFERENT LENGTH!";
+        return;
+    }
+    myRowSum.assign(rows, 0);
+    myColumnSum.assign(columns, 0);
+    //bucket the row labels by column
+    std::vector<quint64> offset((quint64) columns + 1, 0);
+    for (size_t v = 0; v < rowOf.size(); v++)
+    {
+        if (rowOf[v] == NO_LABEL || columnOf[v] == NO_LABEL)
+            continue;
+        if (rowOf[v] >= rows || columnOf[v] >= columns)
+        {
+            qDebug() << "CONTINGENCY: LABEL OUT OF RANGE" << v;
+            clear();
+            return;
+        }
+        offset[columnOf[v] + 1]++;
+    }
+    for (quint32 j = 0; j < columns; j++)
+        offset[j+1] += offset[j];
+    myTotal = offset[columns];
+    std::vector<quint32> bucket(myTotal);
+    std::vector<quint64> fill(offset.begin(), offset.end() - 1);
+    for (size_t v = 0; v < rowOf.size(); v++)
+    {
+        if (rowOf[v] == NO_LABEL || columnOf[v] == NO_LABEL)
+            continue;
+        bucket[fill[columnOf[v]]++] = rowOf[v];
+    }
+    //sort every column, count its distinct rows, then write the cells
+    std::vector<quint64> cells((quint64) columns + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (qint64 j = 0; j < (qint64) columns; j++)
+    {
+        std::sort(bucket.begin() + offset[j], bucket.begin() + offset[j+1]);
+        quint64 distinct = 0;
+        for (quint64 s = offset[j]; s < offset[j+1]; s++)
+            if (s == offset[j] || bucket[s] != bucket[s-1])    distinct++;
+        cells[j+1] = distinct;
+    }
+    for (quint32 j = 0; j < columns; j++)
+        cells[j+1] += cells[j];
+    myCellRow.resize(cells[columns]);
+    myCellColumn.resize(cells[columns]);
+    myCellCount.resize(cells[columns]);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (qint64 j = 0; j < (qint64) columns; j++)
+    {
+        quint64 k = cells[j];
+        for (quint64 s = offset[j]; s < offset[j+1]; s++)
+        {
+            if (s > offset[j] && bucket[s] == bucket[s-1])
+            {
+                myCellCount[k-1]++;
+                continue;
+            }
+            myCellRow[k] = bucket[s];
+            myCellColumn[k] = j;
+            myCellCount[k] = 1;
+            k++;
+        }
+        myColumnSum[j] = offset[j+1] - offset[j];
+    }
+    for (quint64 k = 0; k < myCellCount.size(); k++)
+        myRowSum[myCellRow[k]] += myCellCount[k];
+    myColumnOffset.swap(cells);
+}
+
+void ContingencyTable::clear()
+{
+    myCellRow.clear();
+    myCellColumn.clear();
+    myCellCount.clear();
+    myRowSum.clear();
+    myColumnSum.clear();
+    myColumnOffset.clear();
+    myTotal = 0;
+}
+
+/** Number of vertices labelled on both sides
+ * @brief ContingencyTable::total
+ * @return
+ */
+quint64 ContingencyTable::total() const
+{
+    return myTotal;
+}
+
+quint32 ContingencyTable::getNumberOfRows() const
+{
+    return myRowSum.size();
+}
+
+quint32 ContingencyTable::getNumberOfColumns() const
+{
+    return myColumnSum.size();
+}
+
+quint64 ContingencyTable::getNumberOfCells() const
+{
+    return myCellCount.size();
+}
+
+/** H = - sum s/n log(s/n), natural logarithm
+ * @brief ContingencyTable::entropy
+ * @param sums
+ * @param n
+ * @return
+ */
+double ContingencyTable::entropy(const std::vector<quint64> &sums, const quint64 &n)
+{
+    if (n == 0)
+        return 0.0;
+    double h = 0.0;
+    qint64 size = sums.size();
+    #pragma omp parallel for reduction(+:h)
+    for (qint64 i = 0; i < size; i++)
+    {
+        if (sums[i] == 0)
+            continue;
+        double p = (double) sums[i] / n;
+        h -= p * std::log(p);
+    }
+    return h;
+}
+
+double ContingencyTable::rowEntropy() const
+{
+    return entropy(myRowSum, myTotal);
+}
+
+double ContingencyTable::columnEntropy() const
+{
+    return entropy(myColumnSum, myTotal);
+}
+
+/** I(R;C) = sum n(i,j)/n log(n n(i,j) / (n(i) n(j)))
+ * @brief ContingencyTable::mutualInformation
+ * @return
+ */
+double ContingencyTable::mutualInformation() const
+{
+    if (myTotal == 0)
+        return 0.0;
+    double mi = 0.0, n = myTotal;
+    qint64 size = myCellCount.size();
+    #pragma omp parallel for reduction(+:mi)
+    for (qint64 k = 0; k < size; k++)
+    {
+        double nij = myCellCount[k];
+        mi += nij / n * std::log(n * nij / ((double) myRowSum[myCellRow[k]] * myColumnSum[myCellColumn[k]]));
+    }
+    return mi;
+}
+
+/** NMI normalised by the arithmetic mean of the entropies, 2 I / (H(R) + H(C)).
+ * Two single-community labellings are taken as identical
+ * @brief ContingencyTable::nmiArithmetic
+ * @return
+ */
+double ContingencyTable::nmiArithmetic() const
+{
+    double hr = rowEntropy(), hc = columnEntropy();
+    if (hr + hc == 0.0)
+        return 1.0;
+    return 2.0 * mutualInformation() / (hr + hc);
+}
+
+/** NMI normalised by the geometric mean of the entropies, I / sqrt(H(R) H(C))
+ * @brief ContingencyTable::nmiGeometric
+ * @return
+ */
+double ContingencyTable::nmiGeometric() const
+{
+    double hr = rowEntropy(), hc = columnEntropy();
+    if (hr == 0.0 || hc == 0.0)
+        return hr == hc ? 1.0 : 0.0;
+    return mutualInformation() / std::sqrt(hr * hc);
+}
+
+/** VI = H(R) + H(C) - 2 I(R;C), in nats
+ * @brief ContingencyTable::variationOfInformation
+ * @return
+ */
+double ContingencyTable::variationOfInformation() const
+{
+    double vi = rowEntropy() + columnEntropy() - 2.0 * mutualInformation();
+    return vi < 0.0 ? 0.0 : vi;
+}
+
+/** Fraction of vertices that fall in the majority row of their column,
+ * i.e. of the result clusters w.r.t the ground truth when rows are the truth
+ * @brief ContingencyTable::purity
+ * @return
+ */
+double ContingencyTable::purity() const
+{
+    if (myTotal == 0)
+        return 0.0;
+    //cells of one column are contiguous
+    quint64 majority = 0, best = 0;
+    for (quint64 k = 0; k < myCellCount.size(); k++)
+    {
+        if (k > 0 && myCellColumn[k] != myCellColumn[k-1])
+        {
+            majority += best;
+            best = 0;
+        }
+        best = qMax(best, myCellCount[k]);
+    }
+    majority += best;
+    return (double) majority / myTotal;
+}
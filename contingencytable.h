@@ -0,0 +1,57 @@
+#ifndef CONTINGENCYTABLE_H
+#define CONTINGENCYTABLE_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Sparse contingency table of two labellings of the same vertices.
+ * Only the non-zero cells n(i,j) are kept, one per (row, column) pair that
+ * shares a vertex, so its size is at most the number of labelled vertices
+ * however many communities either side has. Every partition comparison
+ * (pair counting or information theoretic) is a single pass over the cells.
+ */
+class ContingencyTable
+{
+public:
+    static const quint32 NO_LABEL = 0xFFFFFFFF;
+
+    ContingencyTable();
+
+    void build(const std::vector<quint32> &rowOf, const quint32 &rows,
+               const std::vector<quint32> &columnOf, const quint32 &columns);
+    void clear();
+
+    quint64 total() const;
+    quint32 getNumberOfRows() const;
+    quint32 getNumberOfColumns() const;
+    quint64 getNumberOfCells() const;
+    inline quint32 cellRow(const quint64 &k) const { return myCellRow[k]; }
+    inline quint32 cellColumn(const quint64 &k) const { return myCellColumn[k]; }
+    inline quint64 cellCount(const quint64 &k) const { return myCellCount[k]; }
+    inline quint64 rowSum(const quint32 &i) const { return myRowSum[i]; }
+    inline quint64 columnSum(const quint32 &j) const { return myColumnSum[j]; }
+    inline quint64 columnBegin(const quint32 &j) const { return myColumnOffset[j]; }
+    inline quint64 columnEnd(const quint32 &j) const { return myColumnOffset[j+1]; }
+
+    double rowEntropy() const;
+    double columnEntropy() const;
+    double mutualInformation() const;
+    double nmiArithmetic() const;
+    double nmiGeometric() const;
+    double variationOfInformation() const;
+    double purity() const;
+
+private:
+    static double entropy(const std::vector<quint64> &sums, const quint64 &n);
+
+    std::vector<quint32> myCellRow;
+    std::vector<quint32> myCellColumn;
+    std::vector<quint64> myCellCount;
+    std::vector<quint64> myRowSum;
+    std::vector<quint64> myColumnSum;
+    //cells of column j are [myColumnOffset[j], myColumnOffset[j+1])
+    std::vector<quint64> myColumnOffset;
+    quint64 myTotal;
+};
+
+#endif // CONTINGENCYTABLE_H
@@ -0,0 +1,306 @@
+#include "csrgraph.h"
+
+#include <algorithm>
+
+#include <QDebug>
+
+CSRGraph::CSRGraph()
+{
+    myEdges = 0;
+    myEdgeIdBound = 0;
+}
+
+/** Counting sort of both directions of every edge, then sort each slice by neighbour.
+ * Self loops are dropped. Edge i is (from[i], to[i]) with id ids[i]
+ * @brief CSRGraph::build
+ * @param n number of vertices, ids in [0, n)
+ * @param from
+ * @param to
+ * @param ids
+ */
+void CSRGraph::build(const quint32 &n,
+                     const std::vector<quint32> &from,
+                     const std::vector<quint32> &to,
+                     const std::vector<quint32> &ids)
+{
+    clear();
+    if (from.size() != to.size() || from.size() != ids.size())
+    {
+        qDebug() << "CSR: EDGE ARRAYS OF DIFFERENT LENGTH!";
+        return;
+    }
+    myOffset.assign((quint64) n + 1, 0);
+    for (size_t i = 0; i < from.size(); i++)
+    {
+        if (from[i] == to[i])
+            continue;
+        myOffset[from[i]+1]++;
+        myOffset[to[i]+1]++;
+        myEdges++;
+        myEdgeIdBound = qMax(myEdgeIdBound, ids[i] + 1);
+    }
+    for (quint32 v = 0; v < n; v++)
+        myOffset[v+1] += myOffset[v];
+
+    std::vector<quint64> packed(myOffset[n]);
+    std::vector<quint64> fill(myOffset.begin(), myOffset.end() - 1);
+    for (size_t i = 0; i < from.size(); i++)
+    {
+        if (from[i] == to[i])
+            continue;
+        packed[fill[from[i]]++] = ((quint64) to[i] << 32) | ids[i];
+        packed[fill[to[i]]++] = ((quint64) from[i] << 32) | ids[i];
+    }
+    myAdj.resize(packed.size());
+    myEdgeId.resize(packed.size());
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (qint64 v = 0; v < (qint64) n; v++)
+    {
+        std::sort(packed.begin() + myOffset[v], packed.begin() + myOffset[v+1]);
+        for (quint64 s = myOffset[v]; s < myOffset[v+1]; s++)
+        {
+            myAdj[s] = (quint32) (packed[s] >> 32);
+            myEdgeId[s] = (quint32) packed[s];
+        }
+    }
+}
+
+void CSRGraph::clear()
+{
+    myOffset.clear();
+    myAdj.clear();
+    myEdgeId.clear();
+    myEdges = 0;
+    myEdgeIdBound = 0;
+}
+
+bool CSRGraph::isEmpty() const
+{
+    return myOffset.size() <= 1;
+}
+
+quint32 CSRGraph::getNumberOfVertices() const
+{
+    return myOffset.empty() ? 0 : myOffset.size() - 1;
+}
+
+quint64 CSRGraph::getNumberOfEdges() const
+{
+    return myEdges;
+}
+
+/** Edge ids are in [0, bound)
+ * @brief CSRGraph::getEdgeIdBound
+ * @return
+ */
+quint32 CSRGraph::getEdgeIdBound() const
+{
+    return myEdgeIdBound;
+}
+
+/** Number of triangles on every edge (indexed by edge id).
+ * Forward algorithm: orient each edge towards the endpoint of higher
+ * (degree, id) rank, so every out-list has O(sqrt m) entries and each
+ * triangle is found exactly once from its lowest ranked corner: O(m^1.5).
+ * Vertices are processed in parallel, each thread with its own marks
+ * @brief CSRGraph::edgeSupport
+ * @return
+ */
+std::vector<quint32> CSRGraph::edgeSupport() const
+{
+    std::vector<quint32> support(myEdgeIdBound, 0);
+    quint32 n = getNumberOfVertices();
+    if (n == 0)
+        return support;
+    //oriented out-lists
+    std::vector<quint64> outOffset((quint64) n + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (quint32 v = 0; v < n; v++)
+    {
+        quint32 dv = degree(v);
+        for (quint64 s = begin(v); s < end(v); s++)
+        {
+            quint32 u = myAdj[s], du = degree(u);
+            if (dv < du || (dv == du && v < u))
+                outOffset[v+1]++;
+        }
+    }
+    for (quint32 v = 0; v < n; v++)
+        outOffset[v+1] += outOffset[v];
+    std::vector<quint32> outAdj(outOffset[n]), outId(outOffset[n]);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (quint32 v = 0; v < n; v++)
+    {
+        quint32 dv = degree(v);
+        quint64 k = outOffset[v];
+        for (quint64 s = begin(v); s < end(v); s++)
+        {
+            quint32 u = myAdj[s], du = degree(u);
+            if (dv < du || (dv == du && v < u))
+            {
+                outAdj[k] = u;
+                outId[k] = myEdgeId[s];
+                k++;
+            }
+        }
+    }
+    #pragma omp parallel
+    {
+        //mark[w] holds 1 + id of edge (v,w) while v is processed
+        std::vector<quint32> mark(n, 0);
+        #pragma omp for schedule(dynamic, 64)
+        for (quint32 v = 0; v < n; v++)
+        {
+            for (quint64 s = outOffset[v]; s < outOffset[v+1]; s++)
+                mark[outAdj[s]] = outId[s] + 1;
+            for (quint64 s = outOffset[v]; s < outOffset[v+1]; s++)
+            {
+                quint32 u = outAdj[s];
+                for (quint64 r = outOffset[u]; r < outOffset[u+1]; r++)
+                {
+                    quint32 w = outAdj[r];
+                    if (mark[w] != 0)
+                    {
+                        #pragma omp atomic
+                        support[outId[s]]++;
+                        #pragma omp atomic
+                        support[outId[r]]++;
+                        #pragma omp atomic
+                        support[mark[w] - 1]++;
+                    }
+                }
+            }
+            for (quint64 s = outOffset[v]; s < outOffset[v+1]; s++)
+                mark[outAdj[s]] = 0;
+        }
+    }
+    return support;
+}
+
+/** Number of triangles through every vertex, i.e. the number of connected
+ * pairs of its neighbours. Every triangle at v uses two edges of v, so this
+ * is half the support summed over v's edges
+ * @brief CSRGraph::vertexTriangles
+ * @param support as returned by edgeSupport()
+ * @return
+ */
+std::vector<quint32> CSRGraph::vertexTriangles(const std::vector<quint32> &support) const
+{
+    quint32 n = getNumberOfVertices();
+    std::vector<quint32> triangles(n, 0);
+    if (support.size() < myEdgeIdBound)
+    {
+        qDebug() << "CSR: SUPPORT DOES NOT COVER EVERY EDGE!";
+        return triangles;
+    }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (quint32 v = 0; v < n; v++)
+    {
+        quint64 sum = 0;
+        for (quint64 s = begin(v); s < end(v); s++)
+            sum += support[myEdgeId[s]];
+        triangles[v] = (quint32) (sum / 2);
+    }
+    return triangles;
+}
+
+/** Number of triangles through a single vertex: N(v) is marked once, then every
+ * neighbour slice is checked against the marks, so one vertex costs
+ * O(d(v) + sum of d(u)). Every triangle is found from both of its other corners
+ * @brief CSRGraph::vertexTriangles
+ * @param v
+ * @param mark one per thread, getNumberOfVertices() entries all 0, left all 0
+ * @return
+ */
+quint32 CSRGraph::vertexTriangles(const quint32 &v, std::vector<char> &mark) const
+{
+    if (mark.size() < getNumberOfVertices())
+    {
+        qDebug() << "CSR: MARKS DO NOT COVER EVERY VERTEX!";
+        return 0;
+    }
+    for (quint64 s = begin(v); s < end(v); s++)
+        mark[myAdj[s]] = 1;
+    quint64 found = 0;
+    for (quint64 s = begin(v); s < end(v); s++)
+    {
+        quint32 u = myAdj[s];
+        for (quint64 r = begin(u); r < end(u); r++)
+            found += mark[myAdj[r]];
+    }
+    for (quint64 s = begin(v); s < end(v); s++)
+        mark[myAdj[s]] = 0;
+    return (quint32) (found / 2);
+}
+
+/** Core number of every vertex: the largest k such that the vertex survives in
+ * the k-core. Level synchronous bucket peeling: at level k the bucket holds the
+ * vertices whose remaining degree dropped to k or below, they are peeled in
+ * parallel and every neighbour whose degree falls to k joins the next bucket
+ * of the same level. Each edge is decremented at most twice, and only the
+ * vertices not yet peeled are scanned when a level opens: O(m + n * levels)
+ * @brief CSRGraph::coreNumbers
+ * @return core numbers indexed by vertex
+ */
+std::vector<quint32> CSRGraph::coreNumbers() const
+{
+    quint32 n = getNumberOfVertices();
+    std::vector<quint32> core(n, 0);
+    std::vector<qint64> deg(n);
+    #pragma omp parallel for schedule(static)
+    for (quint32 v = 0; v < n; v++)
+        deg[v] = degree(v);
+    std::vector<quint32> remaining(n), kept, bucket, next;
+    for (quint32 v = 0; v < n; v++)
+        remaining[v] = v;
+    qint64 k = 0;
+    while (!remaining.empty())
+    {
+        //open level k
+        bucket.clear();
+        for (size_t i = 0; i < remaining.size(); i++)
+            if (deg[remaining[i]] <= k)    bucket.push_back(remaining[i]);
+        while (!bucket.empty())
+        {
+            next.clear();
+            #pragma omp parallel
+            {
+                std::vector<quint32> local;
+                #pragma omp for schedule(dynamic, 64)
+                for (qint64 i = 0; i < (qint64) bucket.size(); i++)
+                {
+                    quint32 v = bucket[i];
+                    core[v] = k;
+                    for (quint64 s = begin(v); s < end(v); s++)
+                    {
+                        quint32 u = myAdj[s];
+                        qint64 left;
+                        #pragma omp atomic read
+                        left = deg[u];
+                        if (left <= k)
+                            continue;
+                        #pragma omp atomic capture
+                        left = --deg[u];
+                        if (left == k)  local.push_back(u);
+                        //lost the race against another decrement, u is already queued
+                        else if (left < k)
+                        {
+                            #pragma omp atomic
+                            deg[u]++;
+                        }
+                    }
+                }
+                #pragma omp critical
+                next.insert(next.end(), local.begin(), local.end());
+            }
+            bucket.swap(next);
+        }
+        //everything peeled at this level had its degree dropped to k or below
+        kept.clear();
+        for (size_t i = 0; i < remaining.size(); i++)
+            if (deg[remaining[i]] > k)  kept.push_back(remaining[i]);
+        remaining.swap(kept);
+        k++;
+    }
+    return core;
+}
@@ -0,0 +1,47 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Compressed sparse row snapshot of an undirected graph.
+ * Every vertex owns the sorted slice [begin(v), end(v)) of the adjacency and
+ * edge id arrays, so kernels that only read the graph can run on flat
+ * arrays instead of chasing Vertex/Edge pointers.
+ */
+class CSRGraph
+{
+public:
+    CSRGraph();
+
+    void build(const quint32 &n,
+               const std::vector<quint32> &from,
+               const std::vector<quint32> &to,
+               const std::vector<quint32> &ids);
+    void clear();
+
+    bool isEmpty() const;
+    quint32 getNumberOfVertices() const;
+    quint64 getNumberOfEdges() const;
+    quint32 getEdgeIdBound() const;
+
+    inline quint32 degree(const quint32 &v) const { return myOffset[v+1] - myOffset[v]; }
+    inline quint64 begin(const quint32 &v) const { return myOffset[v]; }
+    inline quint64 end(const quint32 &v) const { return myOffset[v+1]; }
+    inline quint32 neighbour(const quint64 &slot) const { return myAdj[slot]; }
+    inline quint32 edgeId(const quint64 &slot) const { return myEdgeId[slot]; }
+
+    std::vector<quint32> edgeSupport() const;
+    std::vector<quint32> vertexTriangles(const std::vector<quint32> &support) const;
+    std::vector<quint32> coreNumbers() const;
+    quint32 vertexTriangles(const quint32 &v, std::vector<char> &mark) const;
+
+private:
+    std::vector<quint64> myOffset;
+    std::vector<quint32> myAdj;
+    std::vector<quint32> myEdgeId;
+    quint64 myEdges;
+    quint32 myEdgeIdBound;
+};
+
+#endif // CSRGRAPH_H
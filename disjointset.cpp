@@ -0,0 +1,75 @@
+#include "disjointset.h"
+
+DisjointSet::DisjointSet()
+{
+    mySets = 0;
+}
+
+DisjointSet::DisjointSet(const quint32 &n)
+{
+    reset(n);
+}
+
+void DisjointSet::reset(const quint32 &n)
+{
+    myParent.resize(n);
+    myLabel.resize(n);
+    mySize.assign(n, 1);
+    for (quint32 i = 0; i < n; i++)
+    {
+        myParent[i] = i;
+        myLabel[i] = i;
+    }
+    mySets = n;
+}
+
+quint32 DisjointSet::find(quint32 x)
+{
+    while (myParent[x] != x)
+    {
+        myParent[x] = myParent[myParent[x]];
+        x = myParent[x];
+    }
+    return x;
+}
+
+/** Union by size; the merged set keeps the label of b's set
+ * @brief DisjointSet::unite
+ * @param a
+ * @param b
+ * @return the new root
+ */
+quint32 DisjointSet::unite(const quint32 &a, const quint32 &b)
+{
+    quint32 ra = find(a), rb = find(b);
+    if (ra == rb)
+        return ra;
+    quint32 label = myLabel[rb];
+    if (mySize[ra] > mySize[rb])
+        qSwap(ra, rb);
+    myParent[ra] = rb;
+    mySize[rb] += mySize[ra];
+    myLabel[rb] = label;
+    mySets--;
+    return rb;
+}
+
+quint32 DisjointSet::getSize(const quint32 &x)
+{
+    return mySize[find(x)];
+}
+
+void DisjointSet::setLabel(const quint32 &x, const quint32 &label)
+{
+    myLabel[find(x)] = label;
+}
+
+quint32 DisjointSet::getLabel(const quint32 &x)
+{
+    return myLabel[find(x)];
+}
+
+quint32 DisjointSet::getNumberOfSets() const
+{
+    return mySets;
+}
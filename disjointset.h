@@ -0,0 +1,33 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Union-find over dense vertex ids with path halving and union by size.
+ * Each set carries a label (e.g. the centroid of the cluster) that is
+ * independent of which element ends up as the internal root.
+ */
+class DisjointSet
+{
+public:
+    DisjointSet();
+    DisjointSet(const quint32 &n);
+
+    void reset(const quint32 &n);
+    quint32 find(quint32 x);
+    quint32 unite(const quint32 &a, const quint32 &b);
+
+    quint32 getSize(const quint32 &x);
+    void setLabel(const quint32 &x, const quint32 &label);
+    quint32 getLabel(const quint32 &x);
+    quint32 getNumberOfSets() const;
+
+private:
+    std::vector<quint32> myParent;
+    std::vector<quint32> mySize;
+    std::vector<quint32> myLabel;
+    quint32 mySets;
+};
+
+#endif // DISJOINTSET_H
@@ -13,6 +13,8 @@ Edge::Edge(Vertex *fromVertex, Vertex *toVertex, quint32 index)
     myToVertex->addAdj(fromVertex->getIndex());
 
     this->index = index;
+    fromSlot = 0xFFFFFFFF;
+    toSlot = 0xFFFFFFFF;
 
 }
 
@@ -49,3 +51,24 @@ quint32 Edge::getIndex() const
 
 
 
+
+/** Position of this edge in the neighbour queue kept by endpoint v
+ * @brief Edge::setSlot
+ * @param v
+ * @param slot
+ */
+void Edge::setSlot(const Vertex *v, const quint32 &slot)
+{
+    if (v == myFromVertex)
+        fromSlot = slot;
+    else
+        toSlot = slot;
+}
+
+quint32 Edge::getSlot(const Vertex *v) const
+{
+    if (v == myFromVertex)
+        return fromSlot;
+    else
+        return toSlot;
+}
@@ -19,10 +19,15 @@ public:
 
     quint32 getIndex() const;
 
+    void setSlot(const Vertex *v, const quint32 &slot);
+    quint32 getSlot(const Vertex *v) const;
+
 protected:
     Vertex *myFromVertex;
     Vertex *myToVertex;
     quint32 index;
+    quint32 fromSlot;
+    quint32 toSlot;
 };
 
 #endif
@@ -0,0 +1,76 @@
+#include "fenwicksampler.h"
+
+#include <QDebug>
+
+FenwickSampler::FenwickSampler()
+{
+    myTotal = 0;
+    myTopBit = 0;
+}
+
+FenwickSampler::FenwickSampler(const quint32 &n)
+{
+    reset(n);
+}
+
+void FenwickSampler::reset(const quint32 &n)
+{
+    myTree.assign((quint64) n + 1, 0);
+    myWeight.assign(n, 0);
+    myTotal = 0;
+    myTopBit = 1;
+    while (myTopBit <= n / 2)
+        myTopBit <<= 1;
+}
+
+void FenwickSampler::set(const quint32 &item, const quint64 &weight)
+{
+    if (item >= myWeight.size())
+    {
+        qDebug() << "FENWICK: ITEM OUT OF RANGE" << item;
+        return;
+    }
+    quint64 old = myWeight[item];
+    if (old == weight)
+        return;
+    myWeight[item] = weight;
+    myTotal = myTotal - old + weight;
+    // unsigned wrap-around makes the same walk serve increases and decreases
+    quint64 delta = weight - old;
+    for (quint64 i = (quint64) item + 1; i < myTree.size(); i += i & (~i + 1))
+        myTree[i] += delta;
+}
+
+void FenwickSampler::remove(const quint32 &item)
+{
+    set(item, 0);
+}
+
+quint64 FenwickSampler::get(const quint32 &item) const
+{
+    return myWeight[item];
+}
+
+quint64 FenwickSampler::total() const
+{
+    return myTotal;
+}
+
+/** Item whose cumulative weight interval contains target, target in [0, total)
+ * @brief FenwickSampler::find
+ * @param target
+ * @return
+ */
+quint32 FenwickSampler::find(quint64 target) const
+{
+    quint64 pos = 0;
+    for (quint64 step = myTopBit; step > 0; step >>= 1)
+    {
+        if (pos + step < myTree.size() && myTree[pos + step] <= target)
+        {
+            pos += step;
+            target -= myTree[pos];
+        }
+    }
+    return (quint32) pos;
+}
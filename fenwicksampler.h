@@ -0,0 +1,37 @@
+#ifndef FENWICKSAMPLER_H
+#define FENWICKSAMPLER_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Draw an item with probability proportional to its weight.
+ * Fenwick (binary indexed) tree over dense ids [0, n): setting a weight,
+ * removing an item (weight 0) and drawing are all O(log n).
+ */
+class FenwickSampler
+{
+public:
+    FenwickSampler();
+    FenwickSampler(const quint32 &n);
+
+    void reset(const quint32 &n);
+    void set(const quint32 &item, const quint64 &weight);
+    void remove(const quint32 &item);
+    quint64 get(const quint32 &item) const;
+    quint64 total() const;
+    quint32 find(quint64 target) const;
+
+    template <typename G>
+    quint32 sample(G &rng) const
+    {
+        return find(rng.bounded64(myTotal));
+    }
+
+private:
+    std::vector<quint64> myTree;
+    std::vector<quint64> myWeight;
+    quint64 myTotal;
+    quint32 myTopBit;
+};
+
+#endif // FENWICKSAMPLER_H
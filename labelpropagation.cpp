@@ -0,0 +1,125 @@
+#include "labelpropagation.h"
+
+#include <algorithm>
+
+#include "csrgraph.h"
+#include "rng.h"
+
+LabelPropagation::LabelPropagation()
+{
+    myRounds = 0;
+}
+
+/**
+ * @brief LabelPropagation::run
+ * @param csr
+ * @param maxRounds the run stops there even if some labels still change
+ */
+void LabelPropagation::run(const CSRGraph &csr, const quint32 &maxRounds)
+{
+    quint32 n = csr.getNumberOfVertices();
+    myLabels.resize(n);
+    myRounds = 0;
+    std::vector<quint32> frontier(n), next;
+    //queued[v]: v is in the frontier and not visited yet
+    std::vector<char> queued(n, 1);
+    for (quint32 v = 0; v < n; v++)
+    {
+        myLabels[v] = v;
+        frontier[v] = v;
+    }
+    while (!frontier.empty() && myRounds < maxRounds)
+    {
+        std::shuffle(frontier.begin(), frontier.end(), Rng::global());
+        next.clear();
+        qint64 size = frontier.size();
+        #pragma omp parallel
+        {
+            std::vector<quint32> neighbours, local;
+            #pragma omp for schedule(dynamic, 256)
+            for (qint64 i = 0; i < size; i++)
+            {
+                quint32 v = frontier[i];
+                #pragma omp atomic write
+                queued[v] = 0;
+                neighbours.clear();
+                for (quint64 s = csr.begin(v); s < csr.end(v); s++)
+                    if (csr.neighbour(s) != v)
+                        neighbours.push_back(myLabels[csr.neighbour(s)]);
+                std::sort(neighbours.begin(), neighbours.end());
+                quint32 own = myLabels[v], best = own, most = 0, ownCount = 0, ties = 0;
+                //one draw per tied label at most, rounds spaced as far apart as Leiden's levels
+                RngStream rng = Rng::stream(v, Rng::LABEL_PROPAGATION_LANE);
+                rng.setCounter((quint64) myRounds << 32);
+                for (size_t k = 0; k < neighbours.size(); )
+                {
+                    quint32 label = neighbours[k], count = 0;
+                    for (; k < neighbours.size() && neighbours[k] == label; k++)
+                        count++;
+                    if (label == own)
+                        ownCount = count;
+                    if (count > most)
+                    {
+                        most = count;
+                        best = label;
+                        ties = 1;
+                    }
+                    else if (count == most && rng.bounded(++ties) == 0)
+                    {
+                        best = label;
+                    }
+                }
+                if (ownCount == most || best == own)
+                    continue;
+                myLabels[v] = best;
+                for (quint64 s = csr.begin(v); s < csr.end(v); s++)
+                {
+                    quint32 u = csr.neighbour(s);
+                    char was;
+                    #pragma omp atomic capture
+                    {
+                        was = queued[u];
+                        queued[u] = 1;
+                    }
+                    if (!was)
+                        local.push_back(u);
+                }
+            }
+            #pragma omp critical
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        frontier.swap(next);
+        myRounds++;
+    }
+}
+
+/** Label of every vertex, the id of the vertex it came from
+ * @brief LabelPropagation::getLabels
+ * @return
+ */
+const std::vector<quint32> & LabelPropagation::getLabels() const
+{
+    return myLabels;
+}
+
+quint32 LabelPropagation::getNumberOfLabels() const
+{
+    std::vector<char> used(myLabels.size(), 0);
+    quint32 k = 0;
+    for (size_t v = 0; v < myLabels.size(); v++)
+    {
+        if (!used[myLabels[v]])
+            k++;
+        used[myLabels[v]] = 1;
+    }
+    return k;
+}
+
+/**
+ * @brief LabelPropagation::getNumberOfRounds
+ * @return rounds run, the last one changing no label unless maxRounds was hit
+ */
+quint32 LabelPropagation::getNumberOfRounds() const
+{
+    return myRounds;
+}
@@ -0,0 +1,34 @@
+#ifndef LABELPROPAGATION_H
+#define LABELPROPAGATION_H
+
+#include <QtGlobal>
+#include <vector>
+
+class CSRGraph;
+
+/** Asynchronous label propagation (Raghavan, Albert and Kumara) on a CSR
+ * snapshot, multithreaded. Every vertex starts with its own label and takes
+ * the label most frequent among its neighbours, keeping its own when that one
+ * is among the most frequent and otherwise breaking the tie with its Rng
+ * stream. Labels are written in place, so later vertices of the same round
+ * already see them. Only the frontier is visited: a round looks at the
+ * vertices with a neighbour whose label changed in the previous round, in a
+ * random order, and the run stops once no label changes.
+ */
+class LabelPropagation
+{
+public:
+    LabelPropagation();
+
+    void run(const CSRGraph &csr, const quint32 &maxRounds);
+
+    const std::vector<quint32> & getLabels() const;
+    quint32 getNumberOfLabels() const;
+    quint32 getNumberOfRounds() const;
+
+private:
+    std::vector<quint32> myLabels;
+    quint32 myRounds;
+};
+
+#endif // LABELPROPAGATION_H
@@ -0,0 +1,480 @@
+#include "louvain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "csrgraph.h"
+#include "disjointset.h"
+#include "rng.h"
+
+namespace
+{
+    const quint32 MAX_LEVELS = 32;
+    const quint32 MAX_SWEEPS = 32;
+    //a sweep that gains less than this ends the local moving of the level
+    const double MIN_GAIN = 1e-7;
+    //randomness of the refinement merges, theta in Traag et al.
+    const double THETA = 0.01;
+
+    typedef std::pair<quint32, double> Link;
+
+    bool byCommunity(const Link &a, const Link &b)
+    {
+        return a.first < b.first;
+    }
+}
+
+Louvain::Louvain()
+{
+    myCommunities = 0;
+    myLevels = 0;
+    myModularity = 0.0;
+    myTotalWeight = 0.0;
+}
+
+/**
+ * @brief Louvain::run
+ * @param csr the graph, every slot weighs 1
+ * @param refine aggregate the refined partition, see refinePartition (Leiden)
+ */
+void Louvain::run(const CSRGraph &csr, const bool &refine)
+{
+    quint32 n = csr.getNumberOfVertices();
+    myLabels.resize(n);
+    myLevels = 0;
+    myModularity = 0.0;
+    for (quint32 v = 0; v < n; v++)
+        myLabels[v] = v;
+    myCommunities = n;
+    if (n == 0)
+        return;
+    Level level;
+    level.offset.resize((quint64) n + 1);
+    level.degree.resize(n);
+    for (quint32 v = 0; v < n; v++)
+    {
+        level.offset[v] = csr.begin(v);
+        level.degree[v] = csr.degree(v);
+    }
+    level.offset[n] = csr.end(n - 1);
+    level.adj.resize(level.offset[n]);
+    level.weight.assign(level.offset[n], 1.0);
+    for (quint64 s = 0; s < level.offset[n]; s++)
+        level.adj[s] = csr.neighbour(s);
+    myTotalWeight = level.offset[n];
+    if (myTotalWeight == 0.0)
+        return;
+    //top[v]: node of the current level that holds the original vertex v
+    std::vector<quint32> top(myLabels), community(myLabels), part;
+    for (;;)
+    {
+        myLevels++;
+        moveNodes(level, community);
+        quint32 communities = renumber(community), parts = communities;
+        if (refine)
+            parts = refinePartition(level, community, communities, part);
+        //nothing refined merged, aggregate the communities themselves as leidenalg does
+        if (parts == level.size())
+            parts = communities;
+        if (parts == communities)
+            part = community;
+        //done once every community is a single node; with refinement a level that
+        //moves nothing still aggregates, so that whole communities may merge later
+        if (communities == level.size() || myLevels == MAX_LEVELS)
+            break;
+        //the parts become the nodes of the next level, starting in their community
+        std::vector<quint32> start(parts);
+        for (quint32 u = 0; u < level.size(); u++)
+            start[part[u]] = community[u];
+        Level next;
+        aggregate(level, part, parts, next);
+        level = std::move(next);
+        community.swap(start);
+        #pragma omp parallel for
+        for (qint64 v = 0; v < n; v++)
+            top[v] = part[top[v]];
+    }
+    //the last moves may still disconnect a community, splitting it never lowers Q
+    if (refine)
+        splitDisconnected(level, community, part);
+    const std::vector<quint32> &last = refine ? part : community;
+    #pragma omp parallel for
+    for (qint64 v = 0; v < n; v++)
+        myLabels[v] = last[top[v]];
+    myCommunities = *std::max_element(last.begin(), last.end()) + 1;
+    myModularity = modularity(level, last, myTotalWeight);
+}
+
+/** Community of every vertex, 0 .. getNumberOfCommunities() - 1
+ * @brief Louvain::getLabels
+ * @return
+ */
+const std::vector<quint32> & Louvain::getLabels() const
+{
+    return myLabels;
+}
+
+quint32 Louvain::getNumberOfCommunities() const
+{
+    return myCommunities;
+}
+
+quint32 Louvain::getNumberOfLevels() const
+{
+    return myLevels;
+}
+
+double Louvain::getModularity() const
+{
+    return myModularity;
+}
+
+/** Local moving on one level, vertices in parallel. Moving v from its community
+ * C to D changes 2m Q by 2 (k_v,D - k_v,C\v) - 2 k_v (tot_D - tot_C\v) / 2m, so v
+ * goes to the neighbouring community of highest k_v,D - k_v tot_D / 2m if it
+ * beats staying. Moves are applied at once and the volumes updated atomically,
+ * so a thread may decide on a slightly stale assignment; on one thread this is
+ * the sequential Louvain sweep. After the first sweep only the vertices with a
+ * neighbour that moved are looked at again (pruning, Ozaki et al.), the others
+ * would make the same choice. A sweep that lowers Q is undone and ends the level
+ * @brief Louvain::moveNodes
+ * @param level
+ * @param community initial assignment, overwritten by the result
+ * @return number of moves kept
+ */
+quint32 Louvain::moveNodes(const Level &level, std::vector<quint32> &community) const
+{
+    qint64 n = level.size();
+    double m2 = myTotalWeight;
+    std::vector<double> total(n, 0.0);
+    for (qint64 v = 0; v < n; v++)
+        total[community[v]] += level.degree[v];
+    std::vector<quint32> previous;
+    std::vector<char> active(n, 1);
+    double Q = modularity(level, community, m2);
+    quint32 moved = 0;
+    for (quint32 sweep = 0; sweep < MAX_SWEEPS; sweep++)
+    {
+        previous = community;
+        quint64 changes = 0;
+        #pragma omp parallel reduction(+:changes)
+        {
+            std::vector<Link> links;
+            #pragma omp for schedule(dynamic, 256)
+            for (qint64 v = 0; v < n; v++)
+            {
+                if (!active[v])
+                    continue;
+                active[v] = 0;
+                quint32 own = community[v], target = own;
+                double k = level.degree[v], kOwn = 0.0;
+                links.clear();
+                for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+                {
+                    quint32 u = level.adj[s], c = community[u];
+                    if (u == v)
+                        continue;
+                    if (c == own)
+                        kOwn += level.weight[s];
+                    else
+                        links.push_back(Link(c, level.weight[s]));
+                }
+                double best = kOwn - k * (total[own] - k) / m2;
+                std::sort(links.begin(), links.end(), byCommunity);
+                for (size_t i = 0; i < links.size(); )
+                {
+                    quint32 c = links[i].first;
+                    double kc = 0.0;
+                    for (; i < links.size() && links[i].first == c; i++)
+                        kc += links[i].second;
+                    double gain = kc - k * total[c] / m2;
+                    if (gain > best)
+                    {
+                        best = gain;
+                        target = c;
+                    }
+                }
+                if (target == own)
+                    continue;
+                #pragma omp atomic
+                total[own] -= k;
+                #pragma omp atomic
+                total[target] += k;
+                community[v] = target;
+                changes++;
+                for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+                    active[level.adj[s]] = 1;
+            }
+        }
+        if (changes == 0)
+            break;
+        double newQ = modularity(level, community, m2);
+        if (newQ < Q)
+        {
+            community.swap(previous);
+            break;
+        }
+        moved += changes;
+        if (newQ - Q < MIN_GAIN)
+            break;
+        Q = newQ;
+    }
+    return moved;
+}
+
+/** Q = sum over communities of in_c / 2m - (tot_c / 2m)^2, self loops counted once
+ * @brief Louvain::modularity
+ * @param level
+ * @param community ids below level.size()
+ * @param m2 total weight, 2m
+ * @return
+ */
+double Louvain::modularity(const Level &level, const std::vector<quint32> &community, const double &m2)
+{
+    qint64 n = level.size();
+    std::vector<double> total(n, 0.0);
+    double internal = 0.0, squares = 0.0;
+    for (qint64 v = 0; v < n; v++)
+        total[community[v]] += level.degree[v];
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:internal)
+    for (qint64 v = 0; v < n; v++)
+        for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+            if (community[level.adj[s]] == community[v])
+                internal += level.weight[s];
+    #pragma omp parallel for reduction(+:squares)
+    for (qint64 c = 0; c < n; c++)
+        squares += total[c] * total[c];
+    return internal / m2 - squares / (m2 * m2);
+}
+
+/** Leiden refinement of one level (Traag, Waltman and van Eck). Inside every
+ * community C, starting from singletons, each vertex v still alone, visited in
+ * random order, may join a refined cluster T of C when both are well connected
+ * in C: w(v, C - v) >= k_v (K_C - k_v) / 2m and w(T, C - T) >= K_T (K_C - K_T) / 2m.
+ * Among the candidates of gain dH = w(v, T) - k_v K_T / 2m >= 0, staying alone
+ * included, T is drawn with probability proportional to exp(dH / theta).
+ * Communities are refined in parallel, each with its own Rng stream, so the
+ * refined partition does not depend on the number of threads
+ * @brief Louvain::refinePartition
+ * @param level
+ * @param community renumbered, below communities
+ * @param communities
+ * @param part refined partition, numbered from 0
+ * @return number of refined clusters
+ */
+quint32 Louvain::refinePartition(const Level &level, const std::vector<quint32> &community,
+                                 const quint32 &communities, std::vector<quint32> &part) const
+{
+    quint32 n = level.size();
+    double m2 = myTotalWeight;
+    std::vector<quint64> first;
+    std::vector<quint32> members;
+    group(community, communities, first, members);
+    //refined clusters are named after a member, so every array is indexed by vertex
+    part.resize(n);
+    std::vector<double> volume(n), boundary(n), inside(n);
+    std::vector<quint32> size(n);
+    #pragma omp parallel
+    {
+        std::vector<Link> links, candidates;
+        std::vector<quint32> order;
+        #pragma omp for schedule(dynamic, 16)
+        for (qint64 c = 0; c < communities; c++)
+        {
+            double K = 0.0;
+            for (quint64 i = first[c]; i < first[c+1]; i++)
+            {
+                quint32 v = members[i];
+                double w = 0.0;
+                for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+                    if (level.adj[s] != v && community[level.adj[s]] == c)
+                        w += level.weight[s];
+                part[v] = v;
+                size[v] = 1;
+                volume[v] = level.degree[v];
+                inside[v] = boundary[v] = w;
+                K += level.degree[v];
+            }
+            RngStream rng = Rng::stream(c, Rng::LEIDEN_LANE);
+            rng.setCounter((quint64) myLevels << 32);
+            order.assign(members.begin() + first[c], members.begin() + first[c+1]);
+            for (size_t i = order.size(); i > 1; i--)
+                std::swap(order[i-1], order[rng.bounded(i)]);
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                quint32 v = order[i];
+                double k = level.degree[v];
+                if (size[part[v]] != 1 || inside[v] < k * (K - k) / m2)
+                    continue;
+                links.clear();
+                for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+                {
+                    quint32 u = level.adj[s];
+                    if (u != v && community[u] == c)
+                        links.push_back(Link(part[u], level.weight[s]));
+                }
+                std::sort(links.begin(), links.end(), byCommunity);
+                //(cluster, w(v, cluster)) of the candidates, gains kept aside
+                candidates.clear();
+                std::vector<double> gains;
+                double most = 0.0;
+                for (size_t j = 0; j < links.size(); )
+                {
+                    quint32 T = links[j].first;
+                    double w = 0.0;
+                    for (; j < links.size() && links[j].first == T; j++)
+                        w += links[j].second;
+                    double gain = w - k * volume[T] / m2;
+                    if (gain < 0.0 || boundary[T] < volume[T] * (K - volume[T]) / m2)
+                        continue;
+                    candidates.push_back(Link(T, w));
+                    gains.push_back(gain);
+                    most = qMax(most, gain);
+                }
+                if (candidates.empty())
+                    continue;
+                candidates.push_back(Link(part[v], 0.0));
+                gains.push_back(0.0);
+                double total = 0.0;
+                for (size_t j = 0; j < gains.size(); j++)
+                    total += gains[j] = std::exp((gains[j] - most) / THETA);
+                double draw = (rng() >> 11) * (1.0 / 9007199254740992.0) * total;
+                size_t chosen = 0;
+                for (; chosen + 1 < gains.size() && draw >= gains[chosen]; chosen++)
+                    draw -= gains[chosen];
+                quint32 T = candidates[chosen].first;
+                if (T == part[v])
+                    continue;
+                boundary[T] += inside[v] - 2 * candidates[chosen].second;
+                volume[T] += k;
+                size[T]++;
+                size[part[v]] = 0;
+                part[v] = T;
+            }
+        }
+    }
+    return renumber(part);
+}
+
+/** Members of every label, label l in members[first[l] .. first[l+1])
+ * @brief Louvain::group
+ * @param label below k
+ * @param k
+ * @param first
+ * @param members
+ */
+void Louvain::group(const std::vector<quint32> &label, const quint32 &k,
+                    std::vector<quint64> &first, std::vector<quint32> &members)
+{
+    first.assign((quint64) k + 1, 0);
+    for (size_t v = 0; v < label.size(); v++)
+        first[label[v] + 1]++;
+    for (quint32 l = 0; l < k; l++)
+        first[l + 1] += first[l];
+    members.resize(label.size());
+    std::vector<quint64> fill(first.begin(), first.end() - 1);
+    for (size_t v = 0; v < label.size(); v++)
+        members[fill[label[v]]++] = v;
+}
+
+/** Connected parts of every community, numbered from 0
+ * @brief Louvain::splitDisconnected
+ * @param level
+ * @param community
+ * @param part
+ * @return number of parts
+ */
+quint32 Louvain::splitDisconnected(const Level &level, const std::vector<quint32> &community, std::vector<quint32> &part)
+{
+    quint32 n = level.size();
+    DisjointSet parts(n);
+    for (quint32 v = 0; v < n; v++)
+        for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+        {
+            quint32 u = level.adj[s];
+            if (u > v && community[u] == community[v])
+                parts.unite(u, v);
+        }
+    part.resize(n);
+    for (quint32 v = 0; v < n; v++)
+        part[v] = parts.find(v);
+    return renumber(part);
+}
+
+/** Relabel to 0 .. k-1 in order of first appearance
+ * @brief Louvain::renumber
+ * @param label values below label.size()
+ * @return k
+ */
+quint32 Louvain::renumber(std::vector<quint32> &label)
+{
+    const quint32 NONE = 0xFFFFFFFF;
+    std::vector<quint32> id(label.size(), NONE);
+    quint32 k = 0;
+    for (size_t v = 0; v < label.size(); v++)
+    {
+        if (id[label[v]] == NONE)
+            id[label[v]] = k++;
+        label[v] = id[label[v]];
+    }
+    return k;
+}
+
+/** One node per part; the weight between two parts is the sum of the weights
+ * between their members, the weight inside a part becomes its self loop
+ * @brief Louvain::aggregate
+ * @param level
+ * @param part
+ * @param parts
+ * @param next
+ */
+void Louvain::aggregate(const Level &level, const std::vector<quint32> &part, const quint32 &parts, Level &next)
+{
+    std::vector<quint64> first;
+    std::vector<quint32> members;
+    group(part, parts, first, members);
+    std::vector<std::vector<Link> > rows(parts);
+    next.degree.assign(parts, 0.0);
+    #pragma omp parallel
+    {
+        std::vector<Link> links;
+        #pragma omp for schedule(dynamic, 64)
+        for (qint64 p = 0; p < parts; p++)
+        {
+            links.clear();
+            double degree = 0.0;
+            for (quint64 i = first[p]; i < first[p+1]; i++)
+            {
+                quint32 v = members[i];
+                degree += level.degree[v];
+                for (quint64 s = level.offset[v]; s < level.offset[v+1]; s++)
+                    links.push_back(Link(part[level.adj[s]], level.weight[s]));
+            }
+            std::sort(links.begin(), links.end(), byCommunity);
+            for (size_t i = 0; i < links.size(); )
+            {
+                Link merged(links[i].first, 0.0);
+                for (; i < links.size() && links[i].first == merged.first; i++)
+                    merged.second += links[i].second;
+                rows[p].push_back(merged);
+            }
+            next.degree[p] = degree;
+        }
+    }
+    next.offset.assign((quint64) parts + 1, 0);
+    for (quint32 p = 0; p < parts; p++)
+        next.offset[p + 1] = next.offset[p] + rows[p].size();
+    next.adj.resize(next.offset[parts]);
+    next.weight.resize(next.offset[parts]);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (qint64 p = 0; p < parts; p++)
+    {
+        for (size_t i = 0; i < rows[p].size(); i++)
+        {
+            next.adj[next.offset[p] + i] = rows[p][i].first;
+            next.weight[next.offset[p] + i] = rows[p][i].second;
+        }
+        std::vector<Link>().swap(rows[p]);
+    }
+}
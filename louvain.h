@@ -0,0 +1,62 @@
+#ifndef LOUVAIN_H
+#define LOUVAIN_H
+
+#include <QtGlobal>
+#include <vector>
+
+class CSRGraph;
+
+/** Multithreaded Louvain modularity optimisation, with an optional Leiden
+ * style refinement, used as a baseline against the random aggregations.
+ * Every level runs local moving with the vertices shared among the threads,
+ * each move applied at once with the community volumes updated atomically
+ * (as in PLM, Staudt and Meyerhenke), until a sweep stops improving Q. The
+ * level is then aggregated into a weighted super graph and the next level
+ * starts from it.
+ * With refinement (Leiden, Traag et al.), every community is first refined
+ * by randomised merges of well connected singletons inside it, the refined
+ * clusters become the nodes of the next level and start it in their
+ * community, so a community may later lose a refined cluster. The final
+ * communities are split into their connected parts.
+ */
+class Louvain
+{
+public:
+    Louvain();
+
+    void run(const CSRGraph &csr, const bool &refine);
+
+    const std::vector<quint32> & getLabels() const;
+    quint32 getNumberOfCommunities() const;
+    quint32 getNumberOfLevels() const;
+    double getModularity() const;
+
+private:
+    //weighted graph of a level, self loops included: A_vv is the weight inside v
+    struct Level
+    {
+        std::vector<quint64> offset;
+        std::vector<quint32> adj;
+        std::vector<double> weight;
+        std::vector<double> degree;
+        quint32 size() const { return degree.size(); }
+    };
+
+    quint32 moveNodes(const Level &level, std::vector<quint32> &community) const;
+    static double modularity(const Level &level, const std::vector<quint32> &community, const double &m2);
+    quint32 refinePartition(const Level &level, const std::vector<quint32> &community,
+                            const quint32 &communities, std::vector<quint32> &part) const;
+    static void group(const std::vector<quint32> &label, const quint32 &k,
+                      std::vector<quint64> &first, std::vector<quint32> &members);
+    static quint32 splitDisconnected(const Level &level, const std::vector<quint32> &community, std::vector<quint32> &part);
+    static quint32 renumber(std::vector<quint32> &label);
+    static void aggregate(const Level &level, const std::vector<quint32> &part, const quint32 &parts, Level &next);
+
+    std::vector<quint32> myLabels;
+    quint32 myCommunities;
+    quint32 myLevels;
+    double myModularity;
+    double myTotalWeight;
+};
+
+#endif // LOUVAIN_H
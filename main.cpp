@@ -9,7 +9,9 @@
 #include <random>
 #include <stdio.h>
 #include <stdlib.h>
+#include <omp.h>
 #include "mygraph.h"
+#include "rng.h"
 
 #include "Snap.h"
 
@@ -25,7 +27,10 @@ enum RandomAgg { I_a, I_b, I_c,
                  R1a,
                  I_x,
                  RFD,
-                 III_z
+                 III_z,
+                 Louvain_Clustering, Leiden_Clustering,
+                 LPA_Clustering,
+                 Parallel_I_a, Parallel_I_b, Parallel_I_c
                };
 const char *name[] = { "I.a", "I.b", "I_c",
                        "II.a", "II.a.i", "II.b", "II.b.i", "II.c", "II.d", "II.e", "II.f", "II.g", "II.h",
@@ -34,7 +39,10 @@ const char *name[] = { "I.a", "I.b", "I_c",
                        "R1a",
                        "I_x",
                        "RFD",
-                       "III.z"
+                       "III.z",
+                       "Louvain", "Leiden",
+                       "LPA",
+                       "Parallel I.a", "Parallel I.b", "Parallel I.c"
                      };
 /** Override Debug Message Handler
  * @brief myMessageOutput
@@ -231,7 +239,7 @@ void GN_experiment()
     for (int z_out = 0 ; z_out <= 12; z_out++)
     {
         QList<double> sRAND, sJACCARD, sARI, sQ, sGN; //s = Set
-        for (int k = 0; k <= 22; k++)
+        for (int k = 0; k <= 26; k++)
         {
             //generate GN graph
             //run algorithm here
@@ -264,6 +272,10 @@ void GN_experiment()
             else if (k == 20){mess.append(QString( "********** R1a ************ /n"));}
             else if (k == 21){mess.append(QString( "********** I.x ************ /n"));}
             else if (k == 22){mess.append(QString( "********** RFD ************ /n"));}
+            else if (k == 23){continue;}
+            else if (k == 24){mess.append(QString( "********** Louvain ************ /n"));}
+            else if (k == 25){mess.append(QString( "********** Leiden ************ /n"));}
+            else if (k == 26){mess.append(QString( "********** LPA ************ /n"));}
             else{}
             for (int i = 0 ; i < times; i++)
             {
@@ -294,6 +306,9 @@ void GN_experiment()
                 else if (k == 20){G.reverse_random_aggregate();}
                 else if (k == 21){G.reverse_random_aggregate_with_degree_comparison();}
                 else if (k == 22){G.random_functional_digraph();}
+                else if (k == 24){G.parallel_louvain(false);}
+                else if (k == 25){G.parallel_louvain(true);}
+                else if (k == 26){G.parallel_label_propagation();}
                 QList<double> id = G.LARGE_compute_Pairwise_efficient(-1); //param -1 set n to |V|
                 iRAND+=id[0];
                 iJACCARD+=id[1];
@@ -365,7 +380,7 @@ void LARGE_Gnp_experiment()
     {
         QList<double> sRAND, sJACCARD, sARI, sQ, sGN,
                       sMapFrac, sMajor  ; //s = Set
-        for (int k = 0; k <= 23; k++)
+        for (int k = 0; k <= 26; k++)
         {
             qDebug() << "-------------------------- New Algorithm -------------------- [p: " << p << " - thres:" << global_p_threshold << "]" ;
             //generate GN graph
@@ -398,6 +413,9 @@ void LARGE_Gnp_experiment()
             else if (k == 21){mess.append(QString( "********** I.x ************ \n"));}
             else if (k == 22){mess.append(QString( "********** RFD ************ \n"));}
             else if (k == 23){mess.append(QString( "********** III.z ************ \n"));}
+            else if (k == 24){mess.append(QString( "********** Louvain ************ \n"));}
+            else if (k == 25){mess.append(QString( "********** Leiden ************ \n"));}
+            else if (k == 26){mess.append(QString( "********** LPA ************ \n"));}
             else{}
             for (int i = 0 ; i < times; i++)
             {
@@ -442,6 +460,9 @@ void LARGE_Gnp_experiment()
                     else if (k == 21){G.reverse_random_aggregate_with_degree_comparison();}
                     else if (k == 22){G.random_functional_digraph();}
                     else if (k == 23){G.random_aggregate_retain_vertex_using_colin_triangulation();}
+                    else if (k == 24){G.parallel_louvain(false);}
+                    else if (k == 25){G.parallel_louvain(true);}
+                    else if (k == 26){G.parallel_label_propagation();}
                     /*QList<double> id = G.LARGE_compute_Pairwise_efficient(n); //param -1 set n to |V|
                     iRAND+=id[0];
                     iJACCARD+=id[1];
@@ -700,9 +721,7 @@ void K_circulant_experiment()
 ///
 int RandomMappingOnACycle(const int& n)
 {
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    generator.seed(qSqrt(QTime::currentTime().msec()));
+    RngBuffer & generator = Rng::global();
     std::uniform_real_distribution<double> dis;
     QList<QPair<int,int> > edge;
     for(int i = 0; i < n; i++)
@@ -839,9 +858,7 @@ void RandomMappingOnACycle_Exp()
 int RandomMappingOnBinaryTree(const int &h)
 {
     unsigned int n = qPow(2,h)-1;
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    generator.seed(qSqrt(QTime::currentTime().msec()));
+    RngBuffer & generator = Rng::global();
     std::uniform_real_distribution<double> dis;
     QList<QPair<int,int> > edge;
     for(int i = 0; i < n; i++)
@@ -1035,7 +1052,7 @@ void SocialGraph_exp(const QString &graph_name)
     for (int t = 0 ; t < 1; t++)
     {
         QList<double> sRAND, sJACCARD, sARI, sQ, sGN; //s = Set
-        for (int k = 0; k <= 22; k++)
+        for (int k = 0; k <= 26; k++)
         {
             //generate GN graph
             int times = 10;
@@ -1065,6 +1082,10 @@ void SocialGraph_exp(const QString &graph_name)
             else if (k == 20){mess.append(QString( "********** R1a ************ /n"));}
             else if (k == 21){mess.append(QString( "********** I.x ************ /n"));}
             else if (k == 22){mess.append(QString( "********** RFD ************ /n"));}
+            else if (k == 23){continue;}
+            else if (k == 24){mess.append(QString( "********** Louvain ************ /n"));}
+            else if (k == 25){mess.append(QString( "********** Leiden ************ /n"));}
+            else if (k == 26){mess.append(QString( "********** LPA ************ /n"));}
             else{}
             for (int i = 0 ; i < times; i++)
             {
@@ -1095,6 +1116,9 @@ void SocialGraph_exp(const QString &graph_name)
                 else if (k == 20){G.reverse_random_aggregate();}
                 else if (k == 21){G.reverse_random_aggregate_with_degree_comparison();}
                 else if (k == 22){G.random_functional_digraph();}
+                else if (k == 24){G.parallel_louvain(false);}
+                else if (k == 25){G.parallel_louvain(true);}
+                else if (k == 26){G.parallel_label_propagation();}
                 QList<double> id = G.LARGE_compute_Pairwise_efficient(-1);
                 iRAND+=id[0];
                 iJACCARD+=id[1];
@@ -1149,7 +1173,7 @@ void LFR_benchmark_exp()
     for (int t = 0 ; t < 1; t++)
     {
         QList<double> sRAND, sJACCARD, sARI, sQ, sGN; //s = Set
-        for (int k = 0; k <= 22; k++)
+        for (int k = 0; k <= 26; k++)
         {
             //generate GN graph
             int times = 5;
@@ -1179,6 +1203,10 @@ void LFR_benchmark_exp()
             else if (k == 20){mess.append(QString( "********** R1a ************ /n"));}
             else if (k == 21){mess.append(QString( "********** I.x ************ /n"));}
             else if (k == 22){mess.append(QString( "********** RFD ************ /n"));}
+            else if (k == 23){continue;}
+            else if (k == 24){mess.append(QString( "********** Louvain ************ /n"));}
+            else if (k == 25){mess.append(QString( "********** Leiden ************ /n"));}
+            else if (k == 26){mess.append(QString( "********** LPA ************ /n"));}
             else{}
             for (int i = 0 ; i < times; i++)
             {
@@ -1219,6 +1247,9 @@ void LFR_benchmark_exp()
                     else if (k == 20){G.reverse_random_aggregate();}
                     else if (k == 21){G.reverse_random_aggregate_with_degree_comparison();}
                     else if (k == 22){G.random_functional_digraph();}
+                    else if (k == 24){G.parallel_louvain(false);}
+                    else if (k == 25){G.parallel_louvain(true);}
+                    else if (k == 26){G.parallel_label_propagation();}
                     QList<double> id = G.LARGE_compute_Pairwise_efficient(-1);
                     if (id[0] > 1 || id[1] > 1 || id[2] > 1)
                     {
@@ -1263,8 +1294,125 @@ void LFR_benchmark_exp()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+/// /brief RNG cost per absorbed vertex
+/// I.a spends two bounded draws per absorbed vertex (candidate then neighbour),
+/// replay exactly those ranges with the old per-iteration distribution and the
+/// Lemire samplers, then compare against a full I.a run on the same graph
+/// /param ell community size of the layered Gnp (n = 4 ell)
+///
+void RNG_microbenchmark(const quint32 &ell)
+{
+    quint32 n = ell*4;
+    double global_p = std::pow((double)n,(double)1/2)/n;
+    Graph G;
+    G.manual_set_working_dir(workingDir);
+    G.generateHiddenGnp_LargeN_layered(global_p, 0.06, ell);
+    writeEdgeFile(G);
+    quint32 avg_deg = qMax((quint32) 1, (quint32) (global_p*n));
+    QElapsedTimer timer;
+    quint64 sink = 0;
+    //old: a fresh std::uniform_int_distribution on an mt19937 for each draw
+    std::mt19937 mt(Rng::getRunSeed());
+    timer.start();
+    for (quint32 i = n; i > 0; i--)
+    {
+        std::uniform_int_distribution<quint32> distribution(0,i-1);
+        std::uniform_int_distribution<quint32> distribution2(0,avg_deg-1);
+        sink += distribution(mt) + distribution2(mt);
+    }
+    qint64 old_ns = timer.nsecsElapsed();
+    //unbuffered counter-based stream
+    RngStream stream = Rng::stream(0);
+    timer.restart();
+    for (quint32 i = n; i > 0; i--)
+        sink += stream.bounded(i) + stream.bounded(avg_deg);
+    qint64 stream_ns = timer.nsecsElapsed();
+    //batched
+    RngBuffer buffer(Rng::stream(1));
+    timer.restart();
+    for (quint32 i = n; i > 0; i--)
+        sink += buffer.bounded(i) + buffer.bounded(avg_deg);
+    qint64 buffer_ns = timer.nsecsElapsed();
+    //full aggregation for reference
+    timer.restart();
+    G.random_aggregate();
+    qint64 agg_ns = timer.nsecsElapsed();
+    printf("- RNG per absorbed vertex (n = %u, checksum %llu)\n"
+           "  uniform_int_distribution: %.2f ns\n"
+           "  RngStream::bounded:       %.2f ns\n"
+           "  RngBuffer::bounded:       %.2f ns\n"
+           "  I.a total:                %.2f ns\n",
+           n, (unsigned long long) sink,
+           (double) old_ns/n, (double) stream_ns/n, (double) buffer_ns/n, (double) agg_ns/n);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// /brief II.b on a preferential attachment graph
+/// power-law degrees are where the Sum d(u) materialisation hurt most: compare the
+/// exact scan with the rejection sampler per draw, then time a full II.b run
+/// /param n
+/// /param k out degree of each new node
+///
+void PowerLaw_II_b_benchmark(const int &n, const int &k)
+{
+    PUNGraph TGraph = TSnap::GenPrefAttach(n, k);
+    Graph G;
+    G.manual_set_working_dir(workingDir);
+    G.read_snap_graph(TGraph);
+    //II.b consumes the edges, the edge file written from G is what reloads them
+    writeEdgeFile(G);
+    G.benchmark_degree_biased_neighbour_sampling(100);
+    QElapsedTimer timer;
+    timer.start();
+    G.random_aggregate_with_neighbour_CURRENT_degree_bias();
+    printf("- II.b on PA(%d, %d): %lld ms\n", n, k, (long long) timer.elapsed());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// /brief Parallel handshake I.a against the sequential I.a
+/// the handshake leaves the Vertex objects alone, so it runs on the same graph for
+/// every thread count; the sequential I.a is destructive and runs last
+/// /param ell
+///
+void Handshake_speedup_benchmark(const quint32 &ell)
+{
+    quint32 n = ell*4;
+    double global_p = std::pow((double)n,(double)1/2)/n;
+    Graph G;
+    G.manual_set_working_dir(workingDir);
+    G.generateHiddenGnp_LargeN_layered(global_p, 0.06, ell);
+    writeEdgeFile(G);
+    QElapsedTimer timer;
+    qint64 single = 0;
+    for (int threads = 1; threads <= omp_get_num_procs(); threads *= 2)
+    {
+        omp_set_num_threads(threads);
+        timer.start();
+        G.parallel_random_aggregate();
+        qint64 ms = timer.elapsed();
+        if (threads == 1)   single = ms;
+        printf("- Parallel I.a, %d threads: %lld ms (speedup %.2f)\n", threads, (long long) ms,
+               ms > 0 ? (double) single / ms : 0.0);
+    }
+    omp_set_num_threads(omp_get_num_procs());
+    timer.start();
+    G.random_aggregate();
+    printf("- Sequential I.a: %lld ms\n", (long long) timer.elapsed());
+}
+
 int main(int argc, char *argv[])
 {
+    //benchmarks, by name on the command line
+    if (argc > 1)
+    {
+        QString bench(argv[1]);
+        if (bench == "handshake")   Handshake_speedup_benchmark(2500);
+        else if (bench == "rng")    RNG_microbenchmark(2500);
+        else if (bench == "powerlaw")   PowerLaw_II_b_benchmark(100000, 5);
+        else qDebug() << "Unknown benchmark" << bench;
+        return 0;
+    }
    // qInstallMessageHandler(myMessageOutput);
     /*
      * Below is for recursive IIIa on Gnp
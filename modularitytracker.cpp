@@ -0,0 +1,50 @@
+#include "modularitytracker.h"
+
+ModularityTracker::ModularityTracker()
+{
+    myEdges = 0;
+    myInternal = 0;
+    mySquares = 0;
+}
+
+/** Every vertex a singleton cluster
+ * @brief ModularityTracker::reset
+ * @param volume degree of every vertex, 0 for a vertex left out of the partition
+ * @param edges m
+ */
+void ModularityTracker::reset(const std::vector<quint64> &volume, const quint64 &edges)
+{
+    myVolume = volume;
+    myEdges = edges;
+    myInternal = 0;
+    mySquares = 0;
+    for (size_t c = 0; c < myVolume.size(); c++)
+        mySquares += myVolume[c]*myVolume[c];
+}
+
+/**
+ * @brief ModularityTracker::merge
+ * @param into cluster that remains
+ * @param from cluster merged into it
+ * @param between number of edges between the two
+ */
+void ModularityTracker::merge(const quint32 &into, const quint32 &from, const quint64 &between)
+{
+    myInternal += between;
+    mySquares += 2*myVolume[into]*myVolume[from];
+    myVolume[into] += myVolume[from];
+    myVolume[from] = 0;
+}
+
+quint64 ModularityTracker::getInternalEdges() const
+{
+    return myInternal;
+}
+
+double ModularityTracker::modularity() const
+{
+    if (myEdges == 0)
+        return 0.0;
+    double m2 = 2.0*myEdges;
+    return (double) myInternal / myEdges - (double) mySquares / (m2*m2);
+}
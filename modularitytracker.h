@@ -0,0 +1,31 @@
+#ifndef MODULARITYTRACKER_H
+#define MODULARITYTRACKER_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Modularity of a partition under a sequence of merges.
+ * Q = sum_in / m - sum_c vol(c)^2 / (2m)^2 with sum_in the number of internal
+ * edges, so merging a and b, joined by e(a,b) edges, is an O(1) update:
+ * sum_in += e(a,b), sum vol^2 += 2 vol(a) vol(b). Both sums are kept as integers,
+ * so Q does not drift however long the merge sequence
+ */
+class ModularityTracker
+{
+public:
+    ModularityTracker();
+
+    void reset(const std::vector<quint64> &volume, const quint64 &edges);
+    void merge(const quint32 &into, const quint32 &from, const quint64 &between);
+
+    quint64 getInternalEdges() const;
+    double modularity() const;
+
+private:
+    std::vector<quint64> myVolume;
+    quint64 myEdges;
+    quint64 myInternal;
+    quint64 mySquares;
+};
+
+#endif // MODULARITYTRACKER_H
@@ -1,5 +1,6 @@
 #include "mygraph.h"
 
+#include <algorithm>
 #include <limits>
 #include <random>
 
@@ -15,13 +16,15 @@
 #include <boost/graph/circle_layout.hpp>
 #include <boost/graph/strong_components.hpp>
 #include <boost/graph/graph_utility.hpp>
-#include <boost/graph/clustering_coefficient.hpp>
 #include <boost/graph/exterior_property.hpp>
 
 #include <QTime>
 
-std::random_device rd;
-std::mt19937 generator(rd());
+#include "rng.h"
+#include "aggregator.h"
+#include "disjointset.h"
+#include "louvain.h"
+#include "labelpropagation.h"
 
 
 QString globalDirPath;
@@ -36,13 +39,24 @@ enum RandomAgg { I_a, I_b, I_c,
                  R1a,
                  I_x,
                  RFD,
-                 III_z
+                 III_z,
+                 Louvain_Clustering, Leiden_Clustering,
+                 LPA_Clustering,
+                 Parallel_I_a, Parallel_I_b, Parallel_I_c
                };
 
 Graph::Graph()
 {   //set up graphic scenes to display all kinds of stuff
     graphIsReady = false;
-    generator.seed(sqrt(QTime::currentTime().msec()*QTime::currentTime().msec()));
+    trianglesAreCounted = false;
+    myTriangleStamp = 0;
+    myTriangleRemovalStamp = 0;
+    coresAreCounted = false;
+    myCoreStamp = 0;
+    foldingEnabled = false;
+    corePeelingEnabled = true;
+    modularityCutEnabled = false;
+    Rng::beginRun();
 }
 
 Graph::~Graph()
@@ -60,6 +74,7 @@ Graph::~Graph()
     centroids.clear();
     //
     ground_truth_communities.clear();
+    overlapping_ground_truth.clear();
     hierarchy.clear();
     large_result.clear();
     large_excluded.clear();
@@ -67,22 +82,92 @@ Graph::~Graph()
 }
 
 // -------------------------------- SNAP CONVERTER/RELATED ----------------------------------
+/** Bulk conversion: the node table is sized up front and every node reserves its
+ * exact degree, then the edges are added in increasing (source, target) order
+ * from a CSR snapshot of the edge list, so every neighbour list is appended at
+ * its end: no hash growth and no reallocation. Self loops, which the CSR drops,
+ * are added last
+ * @brief Graph::convertToSnapUnGraph
+ * @return
+ */
 PUNGraph Graph::convertToSnapUnGraph() const
 {
-    PUNGraph G = TUNGraph::New();
-    for (int i = 0; i < myVertexList.size(); i++)
-        G->AddNode(-1);
-
+    quint32 n = myVertexList.size();
+    std::vector<quint32> from, to, ids;
+    from.reserve(myEdgeList.size());
+    to.reserve(myEdgeList.size());
+    ids.reserve(myEdgeList.size());
     for (int i = 0; i < myEdgeList.size(); i++)
     {
         Edge * e = myEdgeList.at(i);
-        quint32 from = e->fromVertex()->getIndex(),
-                to = e->toVertex()->getIndex();
-        G->AddEdge(from, to);
+        from.push_back(e->fromVertex()->getIndex());
+        to.push_back(e->toVertex()->getIndex());
+        ids.push_back(i);
+    }
+    CSRGraph csr;
+    csr.build(n, from, to, ids);
+
+    PUNGraph G = TUNGraph::New(n, myEdgeList.size());
+    for (quint32 v = 0; v < n; v++)
+        G->AddNode(v);
+    for (quint32 v = 0; v < n; v++)
+        G->ReserveNIdDeg(v, csr.degree(v));
+    for (quint32 v = 0; v < n; v++)
+    {
+        for (quint64 s = csr.begin(v); s < csr.end(v); s++)
+        {
+            quint32 u = csr.neighbour(s);
+            if (u > v)
+                G->AddEdge(v, u); //a parallel edge is refused by SNAP
+        }
     }
+    for (size_t i = 0; i < from.size(); i++)
+        if (from[i] == to[i])   G->AddEdge(from[i], to[i]);
     return G;
 }
 
+/** Build the graph from a SNAP graph in memory, without an edge file.
+ * Vertices are numbered in the order of the node table, which is the node id for
+ * a graph made by convertToSnapUnGraph, and every undirected edge becomes one Edge
+ * @brief Graph::read_snap_graph
+ * @param G
+ */
+void Graph::read_snap_graph(const PUNGraph &G)
+{
+    if (!myVertexList.empty())
+    {
+        qDebug() << "- Graph Is Not Empty! Terminating ...";
+        return;
+    }
+    const quint32 NONE = 0xFFFFFFFF;
+    std::vector<quint32> index(G->GetMxNId(), NONE);
+    myVertexList.reserve(G->GetNodes());
+    for (TUNGraph::TNodeI NI = G->BegNI(); NI < G->EndNI(); NI++)
+    {
+        Vertex * v = new Vertex;
+        v->setIndex(myVertexList.size());
+        index[NI.GetId()] = myVertexList.size();
+        myVertexList.append(v);
+    }
+    myEdgeList.reserve(G->GetEdges());
+    for (TUNGraph::TNodeI NI = G->BegNI(); NI < G->EndNI(); NI++)
+    {
+        Vertex * from = myVertexList.at(index[NI.GetId()]);
+        for (int k = 0; k < NI.GetDeg(); k++)
+        {
+            int u = NI.GetNbrNId(k);
+            if (u < NI.GetId())
+                continue;
+            Edge * e = new Edge(from, myVertexList.at(index[u]), myEdgeList.size());
+            myEdgeList.append(e);
+        }
+    }
+    global_v = myVertexList.size();
+    global_e = myEdgeList.size();
+    graphIsReady = true;
+    qDebug() << "- Read From SNAP:" << myVertexList.size() << myEdgeList.size();
+}
+
 /** Convert to Snap data strucutre
  * @brief Graph::convertCommToSnapVec
  * @param CommV
@@ -155,7 +240,7 @@ void Graph::generateHiddenGnp(double z_in, double z_out)
     {
         for (int j = i+1; j < n; j++)
         {
-            double ran = dis(generator);
+            double ran = dis(Rng::global());
             bool edge = false;
             if (i == j)
                 continue;
@@ -216,6 +301,7 @@ void Graph::generateHiddenGnp(double z_in, double z_out)
 
     graphIsReady = true;
     ground_truth_communities = C;
+    overlapping_ground_truth.clear();
     printf("- Hidden Partition Generated: \nV: %d\nE: %d\nGround Truth Comm: %d\n",
            myVertexList.size(), myEdgeList.size(), ground_truth_communities.size());
 }
@@ -247,7 +333,7 @@ void Graph::generateHiddenGnp_LargeN(double q, double p, quint32 l)
     {
         for (size_t j = i+1; j < n; j++)
         {
-            double ran = dis(generator);
+            double ran = dis(Rng::global());
             bool edge = false;
             if (i == j)
                 continue;
@@ -305,6 +391,7 @@ void Graph::generateHiddenGnp_LargeN(double q, double p, quint32 l)
 
     graphIsReady = true;
     ground_truth_communities = C;
+    overlapping_ground_truth.clear();
     printf("- Hidden Partition Generated: \nV: %d\nE: %d\nGround Truth Comm: %d\n",
            myVertexList.size(), myEdgeList.size(), ground_truth_communities.size());
 }
@@ -335,7 +422,7 @@ void Graph::generateHiddenGnp_LargeN_layered(double global_p, double layer_q, qu
     {
         for (size_t j = i+1; j < n; j++)
         {
-            double ran1 = dis(generator);
+            double ran1 = dis(Rng::global());
             bool edge = false;
             if (i == j)
                 continue;
@@ -349,7 +436,7 @@ void Graph::generateHiddenGnp_LargeN_layered(double global_p, double layer_q, qu
 
             if ((!edge) && (i/l == j/l))
             {
-                double ran2 = dis(generator);
+                double ran2 = dis(Rng::global());
                 if (ran2 <= layer_q)
                 {
                     edge = true;
@@ -395,6 +482,7 @@ void Graph::generateHiddenGnp_LargeN_layered(double global_p, double layer_q, qu
 
     graphIsReady = true;
     ground_truth_communities = C;
+    overlapping_ground_truth.clear();
     printf("- Hidden Partition Generated: \nV: %d\nE: %d\nGround Truth Comm: %d\n",
            myVertexList.size(), myEdgeList.size(), ground_truth_communities.size());
 }
@@ -793,7 +881,9 @@ void Graph::parse_LFR_groundTruth()
                 C.insert(comm);
         }
     }
-    //set ground truth communities
+    //set ground truth communities, replacing any earlier one
+    ground_truth_communities.clear();
+    overlapping_ground_truth.clear();
     for (int i = 0; i < C.size(); i++)
     {
         QList<quint32> c;
@@ -849,7 +939,9 @@ void Graph::parse_LFR_groundTruth(QString filepath, int level)
                 C.insert(comm);
         }
     }
-    //set ground truth communities
+    //set ground truth communities, replacing any earlier one
+    ground_truth_communities.clear();
+    overlapping_ground_truth.clear();
     for (int i = 0; i < C.size(); i++)
     {
         QList<quint32> c;
@@ -1410,6 +1502,7 @@ void Graph::load_ground_truth_communities()
 {
     qDebug() << "PARSING GROUND TRUTH COMMUNITIES";
     ground_truth_communities.clear();
+    overlapping_ground_truth.clear();
     QString file("truth_file.txt");
     if (!locate_file_in_dir(file))
     {
@@ -1448,6 +1541,7 @@ void Graph::load_ground_truth_communities()
         qDebug() << "Now Parsing ...";
         toRead.close();
         remove_excluded_vertices_from_ground_truth();
+        overlapping_ground_truth = ground_truth_communities;
         large_process_overlap_by_seperate_intersection();
     }
 }
@@ -1510,6 +1604,154 @@ void Graph::reConnectGraph()
     return;
 }
 
+/** Let every vertex keep its neighbours ordered by key (see Vertex::trackNeighbours)
+ * @brief Graph::track_neighbour_keys
+ * @param key
+ */
+void Graph::track_neighbour_keys(const int &key)
+{
+    for (int i = 0; i < myVertexList.size(); i++)
+        myVertexList.at(i)->trackNeighbours(key);
+}
+
+/** Flat snapshot of the current edges, edge ids are Edge::getIndex()
+ * @brief Graph::build_csr
+ * @param csr
+ */
+void Graph::build_csr(CSRGraph &csr)
+{
+    std::vector<quint32> from, to, ids;
+    from.reserve(myEdgeList.size());
+    to.reserve(myEdgeList.size());
+    ids.reserve(myEdgeList.size());
+    //the live edges, i.e. not those dropped by an absorption or a fold
+    for (int i = 0; i < myVertexList.size(); i++)
+    {
+        Vertex * v = myVertexList.at(i);
+        for (quint32 j = 0; j < v->getNumberEdge(); j++)
+        {
+            Edge * e = v->getEdge(j);
+            if (e->fromVertex() != v)
+                continue;
+            from.push_back(v->getIndex());
+            to.push_back(e->toVertex()->getIndex());
+            ids.push_back(e->getIndex());
+        }
+    }
+    csr.build(myVertexList.size(), from, to, ids);
+}
+
+/** Triangle counts of the current edge list: per edge (support, indexed by
+ * Edge::getIndex()) and per vertex (pairs of connected neighbours).
+ * Counted once by the parallel forward algorithm on a CSR snapshot and kept
+ * until an edge is added or removed, so the triangle based aggregations and
+ * the clustering coefficient share one O(m^1.5) pass
+ * @brief Graph::count_triangles
+ */
+void Graph::count_triangles()
+{
+    if (triangles_are_current())
+        return;
+    build_csr(myTriangleCSR);
+    myEdgeSupport = myTriangleCSR.edgeSupport();
+    myVertexTriangles = myTriangleCSR.vertexTriangles(myEdgeSupport);
+    myTriangleStamp = Vertex::getEdgeAdditions();
+    myTriangleRemovalStamp = Vertex::getEdgeRemovals();
+    trianglesAreCounted = true;
+}
+
+/** The triangle cache is exact, so unlike the core numbers and the degree
+ * bounds (upper bounds that stay safe while edges only go) it is stale as soon
+ * as the edge list changes either way
+ * @brief Graph::triangles_are_current
+ * @return
+ */
+bool Graph::triangles_are_current() const
+{
+    return trianglesAreCounted && myTriangleStamp == Vertex::getEdgeAdditions()
+            && myTriangleRemovalStamp == Vertex::getEdgeRemovals()
+            && myVertexTriangles.size() == (size_t) myVertexList.size();
+}
+
+/**
+ * @brief Graph::count_vertex_triangles
+ * @return triangles indexed by vertex index
+ */
+const std::vector<quint32> & Graph::count_vertex_triangles()
+{
+    count_triangles();
+    return myVertexTriangles;
+}
+
+/**
+ * @brief Graph::count_edge_support
+ * @return triangles indexed by edge index
+ */
+const std::vector<quint32> & Graph::count_edge_support()
+{
+    count_triangles();
+    return myEdgeSupport;
+}
+
+/** Core numbers of the current edge list by parallel bucket peeling, see
+ * CSRGraph::coreNumbers. Kept until the edge list grows and cached on every
+ * vertex (Vertex::getCoreNumber) for the selectors. Removals are not checked on
+ * purpose: they only lower core numbers, and a stale upper bound is all the
+ * selectors rely on (unlike the exact triangle cache)
+ * @brief Graph::count_core_numbers
+ * @return core numbers indexed by vertex index
+ */
+const std::vector<quint32> & Graph::count_core_numbers()
+{
+    quint64 stamp = Vertex::getEdgeAdditions();
+    if (coresAreCounted && myCoreStamp == stamp
+            && myCoreNumbers.size() == (size_t) myVertexList.size())
+        return myCoreNumbers;
+    CSRGraph csr;
+    build_csr(csr);
+    myCoreNumbers = csr.coreNumbers();
+    for (int i = 0; i < myVertexList.size(); i++)
+        myVertexList.at(i)->setCoreNumber(myCoreNumbers[i]);
+    myCoreStamp = stamp;
+    coresAreCounted = true;
+    return myCoreNumbers;
+}
+
+/** Drop the cached core numbers, the selectors then count every triangle
+ * @brief Graph::forget_core_numbers
+ */
+void Graph::forget_core_numbers()
+{
+    if (!coresAreCounted)
+        return;
+    for (int i = 0; i < myVertexList.size(); i++)
+        myVertexList.at(i)->setCoreNumber(Vertex::UNKNOWN_CORE);
+    myCoreNumbers.clear();
+    coresAreCounted = false;
+}
+
+/** Top k neighbours by number of mutual neighbours for every vertex at once,
+ * see Vertex::getKMostMutualNeighbours. Vertices are independent and draw
+ * their tie-breaks from their own streams, so the result does not depend on
+ * the number of threads
+ * @brief Graph::batch_k_most_mutual_neighbours
+ * @param k
+ * @param topk edges of vertex i in topk[i], highest first
+ */
+void Graph::batch_k_most_mutual_neighbours(const int &k, std::vector<QList<Edge *> > &topk)
+{
+    const std::vector<quint32> &support = count_edge_support();
+    qint64 n = myVertexList.size();
+    topk.assign(n, QList<Edge*>());
+    #pragma omp parallel
+    {
+        std::vector<std::pair<quint64, quint32> > scratch;
+        #pragma omp for schedule(dynamic, 256)
+        for (qint64 i = 0; i < n; i++)
+            myVertexList.at(i)->getKMostMutualNeighbours(topk[i], k, support, scratch);
+    }
+}
+
 void Graph::clear_edge()
 {
     for(int i = 0 ; i < myVertexList.size(); i++)
@@ -1517,124 +1759,183 @@ void Graph::clear_edge()
     for(int i = 0; i < myEdgeList.size(); i++)
         delete myEdgeList[i];
     myEdgeList.clear();
+    trianglesAreCounted = false;
+    forget_core_numbers();
 }
 
 // -----------------------------RANDOM AGGREGATE CLUSTERING -------------------------
 // ----------------------------------------------------------------------------------
-/** Type I.a - Uniform (Everything is Uniformly at Random)
- * @brief Graph::random_aggregate
+/** Fold (or not) pendant trees and degree-2 chains before every aggregation,
+ * off by default so the rules see the input graph unchanged
+ * @brief Graph::set_folding
+ * @param enabled true to fold, see fold_pendants_and_chains
  */
-void Graph::random_aggregate()
+void Graph::set_folding(const bool &enabled)
 {
-    qDebug() << "CHECKING CONDITION || RECONNECTING GRAPH";
-    qDebug() << "Graph Condition: " << graphIsReady <<";"<<myVertexList.size();
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
+    foldingEnabled = enabled;
+}
 
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-    qDebug() << "STARTING...";
-    while(!players.empty()) //start
+/** Peel the graph into cores before the triangle based rules (III.a-d), so the
+ * vertices of core <= 1, which are in no triangle, skip the triangle counts.
+ * The choices are the same with or without it
+ * @brief Graph::set_core_peeling
+ * @param enabled
+ */
+void Graph::set_core_peeling(const bool &enabled)
+{
+    corePeelingEnabled = enabled;
+}
+
+/** After every aggregation, cut the hierarchy where the modularity peaks
+ * (see cut_hierarchy_at_best_modularity) instead of keeping the whole run
+ * @brief Graph::set_modularity_cut
+ * @param enabled
+ */
+void Graph::set_modularity_cut(const bool &enabled)
+{
+    modularityCutEnabled = enabled;
+}
+
+/** Linear preprocessing that takes vertices with an obvious fate out of play.
+ * Pendant trees: a degree-1 vertex is folded into its only neighbour, which may
+ * in turn become a pendant, so whole trees collapse into the vertex they hang from.
+ * Chains: a maximal path of degree-2 vertices between anchors a and b (degree > 2)
+ * is split in half, the half next to a folds into a and the other half into b.
+ * No edge is added between a and b, so the triangle counts, cores and
+ * modularity still see only input edges; the anchors lose the chain edge.
+ * A chain that leaves and returns to a folds entirely into a. Cycles without an
+ * anchor are left alone.
+ * Every fold is recorded in the hierarchy as (folded, anchor). The folded
+ * vertices lose their edges, so the graph must be reloaded afterwards
+ * @brief Graph::fold_pendants_and_chains
+ * @return number of vertices folded
+ */
+quint32 Graph::fold_pendants_and_chains()
+{
+    quint32 folded = 0;
+    //pendant trees
+    QList<Vertex*> pendants;
+    for (int i = 0; i < myVertexList.size(); i++)
+        if (myVertexList.at(i)->getNumberEdge() == 1)  pendants.append(myVertexList.at(i));
+    for (int i = 0; i < pendants.size(); i++)
     {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        if (selected->is_vertex_absorbed() || selected->getParent() != 0)
-        {
-            qDebug() << "Candidate Has Been Clustered!!!!! ";
-            return;
-        }
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
+        Vertex * v = pendants.at(i);
+        if (v->getNumberEdge() != 1) // its neighbour was folded into it
+            continue;
+        Vertex * u = v->get_neighbour_fromEdge((quint32) 0);
+        hierarchy.append(qMakePair(v->getIndex(), u->getIndex()));
+        u->absorb_dragged_along(v);
+        folded++;
+        if (u->getNumberEdge() == 1)
+            pendants.append(u);
+    }
+    //degree-2 chains, walked from their anchors
+    for (int i = 0; i < myVertexList.size(); i++)
+    {
+        Vertex * a = myVertexList.at(i);
+        if (a->getNumberEdge() <= 2)
+            continue;
+        QList<quint32> adj = a->getNeighbourIndexes();
+        for (int j = 0; j < adj.size(); j++)
         {
-            std::uniform_int_distribution<quint32> distribution2(0,no_neighbour-1);
-            quint32 selected_edge_index = distribution2(generator);
-            Edge * e = selected->getEdge(selected_edge_index);
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            selected->absorb_removeEdge(e);
-            players.removeOne(neighbour);
-            t++;
+            Vertex * prev = a, * cur = myVertexList.at(adj[j]);
+            if (cur->getNumberEdge() != 2 || !cur->getNeighbourIndexes().contains(a->getIndex()))
+                continue;
+            QList<Vertex*> chain;
+            while (cur != a && cur->getNumberEdge() == 2)
+            {
+                chain.append(cur);
+                QList<quint32> ends = cur->getNeighbourIndexes();
+                Vertex * next = myVertexList.at(ends[0] == prev->getIndex() ? ends[1] : ends[0]);
+                prev = cur;
+                cur = next;
+            }
+            Vertex * b = cur;
+            int half = b == a ? chain.size() : (chain.size() + 1) / 2;
+            for (int k = 0; k < chain.size(); k++)
+            {
+                Vertex * anchor = k < half ? a : b;
+                hierarchy.append(qMakePair(chain[k]->getIndex(), anchor->getIndex()));
+                anchor->absorb_dragged_along(chain[k]);
+                folded++;
+            }
         }
     }
-    record_time_and_number_of_cluster(RandomAgg::I_a,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("I.a - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    return folded;
 }
 
-
-/** Ia_i The Inverse of Reverse Random Aggregate
- * @brief Graph::reverse_random_aggregate
+/** Run one aggregation rule (see aggregator.h) over the whole graph and parse its result.
+ * Destructive rules report their winners as centroids, retentive rules are parsed from
+ * the hierarchy and record the time before the number of clusters
+ * @brief Graph::run_aggregator
+ * @param type RandomAgg type for the time and cluster log
+ * @param name printed with the elapsed time
  */
-
-void Graph::reverse_random_aggregate()
+template <class A>
+void Graph::run_aggregator(const int &type, const char *name)
 {
-    qDebug() << "CHECKING CONDITION || RECONNECTING GRAPH";
-    qDebug() << "Graph Condition: " << graphIsReady <<";"<<myVertexList.size();
+    hierarchy.clear();
     if (!checkGraphCondition())
     {
         reConnectGraph();
     }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
     QList<Vertex*> winners;
-
-    quint32 t = 0;
     QTime t0;
     t0.start();
-    qDebug() << "I.a_(i) STARTING...";
-    while(!players.empty()) //start
+    if (foldingEnabled)
     {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        if (selected->is_vertex_absorbed() || selected->getParent() != 0)
-        {
-            qDebug() << "Candidate Has Been Clustered!!!!! ";
-            return;
-        }
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            std::uniform_int_distribution<quint32> distribution2(0,no_neighbour-1);
-            quint32 selected_edge_index = distribution2(generator);
-            Edge * e = selected->getEdge(selected_edge_index);
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            neighbour->absorb_removeEdge(e);
-            players.removeOne(selected);
-            t++;
-        }
+        quint32 folded = fold_pendants_and_chains();
+        qDebug() << "- Folded:" << folded;
+        //the folded vertices lost their edges, the next scorer must reload them
+        if (folded > 0)
+            graphIsReady = false;
+    }
+    if (A::NeighbourRule::TRIANGLES && corePeelingEnabled)
+        count_core_numbers();
+    else
+        forget_core_numbers();
+    A::run(myVertexList, hierarchy, winners);
+    if (A::ModePolicy::RETAIN)
+    {
+        record_time_and_number_of_cluster(type,t0.elapsed(),0); // the number of cluster is only determine later on
+        qDebug("%s - Time elapsed: %d ms", name, t0.elapsed());
+        large_parse_retain_result();
+    }
+    else
+    {
+        //with the modularity cut, the number of clusters is only known after it
+        record_time_and_number_of_cluster(type,t0.elapsed(),modularityCutEnabled ? 0 : winners.size());
+        centroids = winners;
+        qDebug("%s - Time elapsed: %d ms", name, t0.elapsed());
+        large_graph_parse_result();
     }
-    record_time_and_number_of_cluster(RandomAgg::R1a,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("I.a_i - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    if (modularityCutEnabled)
+        cut_hierarchy_at_best_modularity();
+    //time is recorded first
+    if (A::ModePolicy::RETAIN || modularityCutEnabled)
+        record_time_and_number_of_cluster(type,0,large_result.size());
+}
+
+/** Type I.a - Uniform (Everything is Uniformly at Random)
+ * @brief Graph::random_aggregate
+ */
+void Graph::random_aggregate()
+{
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::UniformNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::I_a, "I.a");
+}
+
+
+/** Ia_i The Inverse of Reverse Random Aggregate
+ * @brief Graph::reverse_random_aggregate
+ */
+
+void Graph::reverse_random_aggregate()
+{
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::UniformNeighbour,
+                       AggPolicy::NeighbourWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::R1a, "I.a_i");
 }
 
 /** Type I.b - Uniformly and Comparing the CURRENT DEGREE
@@ -1645,63 +1946,9 @@ void Graph::reverse_random_aggregate()
  */
 void Graph::random_aggregate_with_degree_comparison()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            std::uniform_int_distribution<quint32> distribution2(0,no_neighbour-1);
-            quint32 selected_edge_index = distribution2(generator);
-            Edge * e = selected->getEdge(selected_edge_index);
-            Vertex * neighbour = selected->get_neighbour_fromEdge(selected_edge_index); //get the neighbour (not clean)
-            Vertex * winner, * loser;
-            quint32 selected_d = selected->getNumberEdge(), neighbour_d = neighbour->getNumberEdge();
-            if (selected_d >= neighbour_d)
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-            else
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-
-            //abosbr
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            winner->absorb_removeEdge(e);
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::I_b,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("I.b - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::UniformNeighbour,
+                       AggPolicy::HigherDegreeWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::I_b, "I.b");
 }
 
 /** REVERSE I.b or I.x
@@ -1712,63 +1959,9 @@ void Graph::random_aggregate_with_degree_comparison()
  */
 void Graph::reverse_random_aggregate_with_degree_comparison()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            std::uniform_int_distribution<quint32> distribution2(0,no_neighbour-1);
-            quint32 selected_edge_index = distribution2(generator);
-            Edge * e = selected->getEdge(selected_edge_index);
-            Vertex * neighbour = selected->get_neighbour_fromEdge(selected_edge_index); //get the neighbour (not clean)
-            Vertex * winner, * loser;
-            quint32 selected_d = selected->getNumberEdge(), neighbour_d = neighbour->getNumberEdge();
-            if (selected_d > neighbour_d)
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-            else
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-
-            //abosbr
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            winner->absorb_removeEdge(e);
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::I_x,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("I.x - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::UniformNeighbour,
+                       AggPolicy::LowerDegreeWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::I_x, "I.x");
 }
 
 
@@ -1780,67 +1973,231 @@ void Graph::reverse_random_aggregate_with_degree_comparison()
  */
 void Graph::random_aggregate_with_weight_comparison()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (quint32 i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::UniformNeighbour,
+                       AggPolicy::HigherWeightWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::I_c, "I.c");
+}
 
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
+/** Parallel I.a - Uniform, see parallel_handshake_aggregate
+ * @brief Graph::parallel_random_aggregate
+ */
+void Graph::parallel_random_aggregate()
+{
+    parallel_handshake_aggregate(RandomAgg::I_a);
+}
 
-    while(!players.empty()) //start
+/** Parallel I.b - Degree Comparison, see parallel_handshake_aggregate
+ * @brief Graph::parallel_random_aggregate_with_degree_comparison
+ */
+void Graph::parallel_random_aggregate_with_degree_comparison()
+{
+    parallel_handshake_aggregate(RandomAgg::I_b);
+}
+
+/** Parallel I.c - Weight Comparison, see parallel_handshake_aggregate
+ * @brief Graph::parallel_random_aggregate_with_weight_comparison
+ */
+void Graph::parallel_random_aggregate_with_weight_comparison()
+{
+    parallel_handshake_aggregate(RandomAgg::I_c);
+}
+
+/** Bulk synchronous version of I.a/I.b/I.c.
+ * Every round, every player v with a live neighbour proposes one u.a.r and the
+ * rule of the type names the winner of (v,u): v itself (I.a), the higher
+ * current degree (I.b) or the higher initial degree (I.c), ties to v. A proposal
+ * conflicts with any other one whose loser is its winner or its loser, so the
+ * round keeps, Luby style, the proposals of highest random priority among
+ * their conflicts. Those form an independent set and are absorbed at once:
+ * losers leave the graph, winners keep their edges. A player without live
+ * neighbours is declared a winner, as in the sequential versions.
+ * Runs on a CSR copy with an alive array, compacting each adjacency slice
+ * once per round; draws come from per-vertex streams positioned by round, so
+ * the hierarchy does not depend on the number of threads.
+ * Apart from the folding pass, the Vertex objects are not touched: large_result
+ * is built from the parents. Logged under Parallel_I_a, I_b or I_c, apart from
+ * the sequential rules
+ * @brief Graph::parallel_handshake_aggregate
+ * @param type: RandomAgg::I_a, I_b or I_c
+ */
+void Graph::parallel_handshake_aggregate(const int &type)
+{
+    if (type != RandomAgg::I_a && type != RandomAgg::I_b && type != RandomAgg::I_c)
     {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
+        qDebug() << "HANDSHAKE: UNSUPPORTED TYPE" << type;
+        return;
+    }
+    if (!checkGraphCondition())
+    {
+        reConnectGraph();
+    }
+    hierarchy.clear();
+    centroids.clear();
+    QTime t0;
+    t0.start();
+    if (foldingEnabled)
+    {
+        quint32 folded = fold_pendants_and_chains();
+        qDebug() << "- Folded:" << folded;
+        //the folded vertices lost their edges, the next scorer must reload them
+        if (folded > 0)
+            graphIsReady = false;
+    }
+    const quint32 NONE = 0xFFFFFFFF;
+    CSRGraph csr;
+    build_csr(csr);
+    qint64 n = csr.getNumberOfVertices();
+    //live adjacency: slice [first[v], last[v]) holds the neighbours still alive
+    std::vector<quint32> adj(2 * csr.getNumberOfEdges());
+    std::vector<quint64> first(n), last(n);
+    std::vector<quint64> weight(n);
+    std::vector<char> alive(n, 1), isWinner(n, 0);
+    qint64 players = n;
+    for (qint64 v = 0; v < n; v++)
+    {
+        //folded vertices never play, their edges go with the first compaction
+        if (myVertexList.at(v)->is_vertex_dragged_along())
+        {
+            alive[v] = 0;
+            players--;
+        }
+        first[v] = csr.begin(v);
+        last[v] = csr.end(v);
+        for (quint64 s = first[v]; s < last[v]; s++)
+            adj[s] = csr.neighbour(s);
+        //I.c compares the initial degrees, as in the sequential version
+        weight[v] = csr.degree(v);
+    }
+    std::vector<quint32> parent(n, NONE), target(n, NONE);
+    std::vector<quint64> priority(n, 0), maxAsLoser(n, 0), maxAsWinner(n, 0);
+    std::vector<char> proposerWins(n, 0), accepted(n, 0);
+    quint64 round = 0;
+    while (players > 0)
+    {
+        //drop the losers of the last round from the slices
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (qint64 v = 0; v < n; v++)
+        {
+            if (!alive[v])
+                continue;
+            quint64 k = first[v];
+            for (quint64 s = first[v]; s < last[v]; s++)
+                if (alive[adj[s]])  adj[k++] = adj[s];
+            last[v] = k;
+        }
+        //propose
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (qint64 v = 0; v < n; v++)
+        {
+            target[v] = NONE;
+            accepted[v] = 0;
+            if (!alive[v])
+                continue;
+            quint32 d = last[v] - first[v];
+            if (d == 0)
+                continue;
+            RngStream rng = Rng::stream(v, Rng::HANDSHAKE_LANE);
+            rng.setCounter(round << 16);
+            quint32 u = adj[first[v] + rng.bounded(d)];
+            bool wins = true;
+            if (type == RandomAgg::I_b)
+                wins = d >= last[u] - first[u];
+            else if (type == RandomAgg::I_c)
+                wins = weight[v] >= weight[u];
+            target[v] = u;
+            proposerWins[v] = wins;
+            //top bit set so 0 means no proposal, low half makes priorities distinct
+            priority[v] = ((quint64) (rng.next32() | 0x80000000u) << 32) | (quint64) v;
+        }
+        //players left without live neighbours are winners
+        for (qint64 v = 0; v < n; v++)
+        {
+            if (alive[v] && target[v] == NONE)
+            {
+                alive[v] = 0;
+                isWinner[v] = 1;
+                players--;
+            }
         }
-        else // else absorb
+        if (players == 0)
+            break;
+        //highest priority of the proposals in which v loses / wins, pulled from the neighbours
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (qint64 v = 0; v < n; v++)
         {
-
-            std::uniform_int_distribution<quint32> distribution2(0,no_neighbour-1);
-            quint32 selected_edge_index = distribution2(generator);
-            Edge * e = selected->getEdge(selected_edge_index);
-            Vertex * neighbour = selected->get_neighbour_fromEdge(selected_edge_index); //get the neighbour (not clean)
-            Vertex * winner, * loser;
-            quint64 selected_w = selected->getWeight(), neighbour_w = neighbour->getWeight();
-            if (selected_w >= neighbour_w)
+            if (!alive[v])
+                continue;
+            quint64 asLoser = 0, asWinner = 0;
+            if (target[v] != NONE)
             {
-                winner = selected;
-                loser = neighbour;
+                if (proposerWins[v])    asWinner = priority[v];
+                else    asLoser = priority[v];
             }
-            else
+            for (quint64 s = first[v]; s < last[v]; s++)
             {
-                winner = neighbour;
-                loser = selected;
+                quint32 u = adj[s];
+                if (target[u] != (quint32) v)
+                    continue;
+                if (proposerWins[u])    asLoser = qMax(asLoser, priority[u]);
+                else    asWinner = qMax(asWinner, priority[u]);
             }
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            winner->absorb_removeEdge(e);
-            players.removeOne(loser);
-            t++;
+            maxAsLoser[v] = asLoser;
+            maxAsWinner[v] = asWinner;
+        }
+        //keep the proposals that beat all their conflicts
+        #pragma omp parallel for schedule(static)
+        for (qint64 v = 0; v < n; v++)
+        {
+            if (!alive[v] || target[v] == NONE)
+                continue;
+            quint32 w = proposerWins[v] ? v : target[v],
+                    l = proposerWins[v] ? target[v] : v;
+            quint64 p = priority[v];
+            accepted[v] = p == maxAsLoser[l] && p > maxAsWinner[l] && p > maxAsLoser[w];
         }
+        //absorb, in proposer order
+        for (qint64 v = 0; v < n; v++)
+        {
+            if (!accepted[v])
+                continue;
+            quint32 w = proposerWins[v] ? v : target[v],
+                    l = proposerWins[v] ? target[v] : v;
+            parent[l] = w;
+            alive[l] = 0;
+            players--;
+            hierarchy.append(qMakePair(l, w));
+        }
+        round++;
+    }
+    //every loser ends in the cluster of the winner its parents lead to;
+    //a parent is absorbed after its children, so walk the hierarchy backwards
+    std::vector<quint32> root(n);
+    for (qint64 v = 0; v < n; v++)    root[v] = v;
+    for (int i = hierarchy.size() - 1; i >= 0; i--)
+        root[hierarchy.at(i).first] = root[hierarchy.at(i).second];
+    QHash<quint32, int> position;
+    large_result.clear();
+    for (qint64 v = 0; v < n; v++)
+    {
+        if (!isWinner[v])
+            continue;
+        position.insert(v, large_result.size());
+        large_result.append(QList<quint32>());
     }
-    record_time_and_number_of_cluster(RandomAgg::I_c,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("I.c - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    for (qint64 v = 0; v < n; v++)
+    {
+        if (large_excluded.contains(v))
+            continue;
+        large_result[position.value(root[v])].append(v);
+    }
+    for (int i = large_result.size() - 1; i >= 0; i--)
+        if (large_result.at(i).empty())  large_result.removeAt(i);
+    int elapsed = t0.elapsed();
+    qDebug("Handshake - %d rounds, Time elapsed: %d ms", (int) round, elapsed);
+    //the number of clusters is logged after the cut, if any
+    if (modularityCutEnabled)
+        cut_hierarchy_at_best_modularity();
+    record_time_and_number_of_cluster(RandomAgg::Parallel_I_a + type - RandomAgg::I_a, elapsed, large_result.size());
 }
 
 /** Type II.a - Select Neighbour With the ORIGINAL DEGREE BIAS
@@ -1850,53 +2207,9 @@ void Graph::random_aggregate_with_weight_comparison()
  */
 void Graph::random_aggregate_with_neighbour_initial_degree_bias()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-  //  QSequentialAnimationGroup * group_anim = new QSequentialAnimationGroup;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Vertex * neighbour = selected->aggregate_get_degree_biased_neighbour();
-            Edge * e = selected->getEdgeFromVertex(neighbour);
-            //create the animation
-            selected->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            players.removeOne(neighbour);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_a,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.a - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::InitialDegreeBiasedNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_a, "II.a");
 }
 
 /** Rule II.a_i
@@ -1904,62 +2217,9 @@ void Graph::random_aggregate_with_neighbour_initial_degree_bias()
  */
 void Graph::random_aggregate_with_neighbour_initial_degree_bias_with_constraint()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    int t = 0;
-    QTime t0;
-    t0.start();
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        int size = players.size();
-        std::uniform_int_distribution<int> distribution(0,size-1);
-        int selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        int no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Vertex * neighbour = selected->aggregate_get_degree_biased_neighbour();
-            Edge * e = selected->getEdgeFromVertex(neighbour);
-            Vertex * winner, * loser;
-            if (selected->getWeight() >= neighbour->getWeight())
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-            else
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-            winner->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_a_i,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.a(i) - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::InitialDegreeBiasedNeighbour,
+                       AggPolicy::HigherWeightWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_a_i, "II.a(i)");
 }
 
 /** Type II.b - Select Neighbour With the CURRENT Degree Bias
@@ -1970,47 +2230,9 @@ void Graph::random_aggregate_with_neighbour_initial_degree_bias_with_constraint(
  */
 void Graph::random_aggregate_with_neighbour_CURRENT_degree_bias()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getDegreeProbabilisticEdge();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e);
-            selected->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            players.removeOne(neighbour);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_b,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.b - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::CurrentDegreeBiasedNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_b, "II.b");
 }
 
 /** Rule II.b_i
@@ -2018,57 +2240,9 @@ void Graph::random_aggregate_with_neighbour_CURRENT_degree_bias()
  */
 void Graph::random_aggregate_with_neighbour_CURRENT_degree_bias_with_constraint()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    int t = 0;
-    QTime t0;
-    t0.start();
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        int size = players.size();
-        std::uniform_int_distribution<int> distribution(0,size-1);
-        int selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        int no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getDegreeProbabilisticEdge();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e);
-            Vertex * winner, * loser;
-            if (selected->getNumberEdge() >= neighbour->getNumberEdge())
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-            else
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-            winner->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_b_i,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.b(i) - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::CurrentDegreeBiasedNeighbour,
+                       AggPolicy::HigherDegreeWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_b_i, "II.b(i)");
 }
 
 
@@ -2080,60 +2254,9 @@ void Graph::random_aggregate_with_neighbour_CURRENT_degree_bias_with_constraint(
  */
 void Graph::random_aggregate_highest_CURRENT_degree_neighbour()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-   // QSequentialAnimationGroup * group_anim = new QSequentialAnimationGroup;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getHighestDegreeNeighbour();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e);
-            quint32 dv = selected->getNumberEdge(), du = neighbour->getNumberEdge();
-            Vertex * winner, * loser;
-            if (dv >= du)
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-            else
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-
-            winner->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_c,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.c - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::MaxDegreeNeighbour,
+                       AggPolicy::HigherDegreeWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_c, "II.c");
 }
 
 
@@ -2144,52 +2267,9 @@ void Graph::random_aggregate_highest_CURRENT_degree_neighbour()
  */
 void Graph::random_aggregate_with_minimum_weight_neighbour()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-   // QSequentialAnimationGroup * group_anim = new QSequentialAnimationGroup;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getSmallestCurrentDegreeNeighbour();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e);
-            selected->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(neighbour->getIndex(), selected->getIndex()));
-            players.removeOne(neighbour);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_d,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.d - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::MinDegreeNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_d, "II.d");
 }
 
 
@@ -2200,68 +2280,9 @@ void Graph::random_aggregate_with_minimum_weight_neighbour()
  */
 void Graph::random_aggregate_probabilistic_lowest_degree_neighbour_destructive()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        QList<Vertex*> ran_list;
-        for (int i = 0; i < players.size(); i++)
-        {
-            Vertex * v = players.at(i);
-            for (quint32 j = 0; j < v->getNumberEdge(); j++)
-                ran_list.append(v);
-        }
-        if (ran_list.size() == 0)
-        {
-            quint32 size = players.size();
-            std::uniform_int_distribution<quint32> distribution(0,size-1);
-            quint32 selected_index = distribution(generator);
-            Vertex * selected = players.at(selected_index);
-            winners.append(selected);
-            players.removeOne(selected);
-        }
-        else
-        {
-            quint64 size = ran_list.size();
-            std::uniform_int_distribution<quint64> distribution(0,size-1);
-            quint64 selected_index = distribution(generator);
-            Vertex * selected = ran_list.at(selected_index);
-            //get a neighbour
-            quint64 no_neighbour = selected->getNumberEdge();
-            if (no_neighbour == 0) // if there is no neighbour, declare a winner
-            {
-                winners.append(selected);
-                players.removeOne(selected);
-            }
-            else // else absorb
-            {
-                Edge * e = selected->getSmallestCurrentDegreeNeighbour();
-                Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-                Vertex * winner, * loser;
-                winner = selected;
-                loser = neighbour;
-                hierarchy.append(qMakePair(winner->getIndex(), loser->getIndex()));
-
-                winner->absorb_removeEdge(e);
-                players.removeOne(loser);
-            }
-        }
-        t++;
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_e,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.e - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::DegreeProportionalCandidate, AggPolicy::MinDegreeNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_e, "II.e");
 }
 
 
@@ -2273,80 +2294,9 @@ void Graph::random_aggregate_probabilistic_lowest_degree_neighbour_destructive()
  */
 void Graph::random_aggregate_probabilistic_candidate_with_minimum_weight_neighbour()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        QList<Vertex*> ran_list;
-        for (quint32 i = 0 ;i < players.size(); i++)
-        {
-            Vertex * v = players.at(i);
-            quint64 w = v->getWeight();
-            for (quint64 j = 0; j < w; j++)
-                ran_list.append(v);
-        }
-        if (ran_list.size() == 0)
-        {
-            quint32 size = players.size();
-            std::uniform_int_distribution<quint32> distribution(0,size-1);
-            quint32 selected_index = distribution(generator);
-            Vertex * selected = players.at(selected_index);
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else
-        {
-            quint64 size = ran_list.size();
-            std::uniform_int_distribution<quint64> distribution(0,size-1);
-            quint64 selected_index = distribution(generator);
-            Vertex * selected = ran_list.at(selected_index);
-            //get a neighbour
-            quint32 no_neighbour = selected->getNumberEdge();
-            if (no_neighbour == 0) // if there is no neighbour, declare a winner
-            {
-                winners.append(selected);
-                players.removeOne(selected);
-                t++;
-            }
-            else // else absorb
-            {
-                Edge * e = selected->getSmallestCurrentDegreeNeighbour();
-                Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-                Vertex * winner, * loser;
-                winner = selected;
-                loser = neighbour;
-                hierarchy.append(qMakePair(winner->getIndex(), loser->getIndex()));
-                winner->absorb_removeEdge(e);
-                winner->setWeight(loser->getWeight() + winner->getWeight());
-                players.removeOne(loser);
-                t++;
-            }
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_f,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.f - Time elapsed: %d ms", t0.elapsed());
-    // draw_dense_graph_aggregation_result();
-    // group_anim->start();
-    // connect(group_anim, SIGNAL(finished()), this, SLOT(large_graph_parse_result()));
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::WeightProportionalCandidate, AggPolicy::MinDegreeNeighbour,
+                       AggPolicy::SelectedWinsAndGainsWeight, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_f, "II.f");
 }
 
 
@@ -2357,67 +2307,9 @@ void Graph::random_aggregate_probabilistic_candidate_with_minimum_weight_neighbo
  */
 void Graph::random_aggregate_greedy_max_degree()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-   // QSequentialAnimationGroup * group_anim = new QSequentialAnimationGroup;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        QList<Vertex*> ran_list;
-        quint32 max_d = 0;
-        for (int i = 0; i < players.size(); i++)
-        {
-            Vertex * v = players.at(i);
-            quint32 dv = v->getNumberEdge();
-            if (dv > max_d)
-            {
-                max_d = dv;
-                ran_list.clear();
-                ran_list.append(v);
-            }
-            else if (dv == max_d)
-            {
-                ran_list.append(v);
-            }
-        }
-
-        int size = ran_list.size();
-        std::uniform_int_distribution<int> distribution(0,size-1);
-        int selected_index = distribution(generator);
-        Vertex * selected = ran_list.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getSmallestCurrentDegreeNeighbour();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-            Vertex * winner, * loser;
-            winner = selected;
-            loser = neighbour;
-            hierarchy.append(qMakePair(winner->getIndex(), loser->getIndex()));
-            winner->absorb_removeEdge(e);
-            players.removeOne(loser);
-        }
-
-        t++;
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_g,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.g - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::MaxDegreeCandidate, AggPolicy::MinDegreeNeighbour,
+                       AggPolicy::SelectedWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_g, "II.g");
 }
 
 
@@ -2428,75 +2320,9 @@ void Graph::random_aggregate_greedy_max_degree()
  */
 void Graph::random_aggregate_greedy_max_weight()
 {
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        QList<Vertex*> ran_list;
-        quint64 max_w = 0;
-        for (int i = 0; i < players.size(); i++)
-        {
-            Vertex * v = players[i];
-            quint64 wv = v->getWeight();
-            if (wv > max_w)
-            {
-                max_w = wv;
-                ran_list.clear();
-                ran_list.append(v);
-            }
-            else if (wv == max_w)
-            {
-                ran_list.append(v);
-            }
-        }
-
-        int size = ran_list.size();
-        std::uniform_int_distribution<int> distribution(0,size-1);
-        int selected_index = distribution(generator);
-        Vertex * selected = ran_list.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getSmallestCurrentWeightNeighbour();
-            Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
-            Vertex * winner, * loser;
-            winner = selected;
-            loser = neighbour;
-            hierarchy.append(qMakePair(winner->getIndex(), loser->getIndex()));
-            winner->absorb_removeEdge(e);
-            winner->setWeight(loser->getWeight() + winner->getWeight());
-            players.removeOne(loser);
-            t++;
-        }
-
-    }
-    record_time_and_number_of_cluster(RandomAgg::II_h,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("II.h - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::MaxWeightCandidate, AggPolicy::MinWeightNeighbour,
+                       AggPolicy::SelectedWinsAndGainsWeight, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::II_h, "II.h");
 }
 
 /** Type III.c - Select Highest Triangles Neighbour Destructive
@@ -2508,216 +2334,108 @@ void Graph::random_aggregate_greedy_max_weight()
  */
 void Graph::random_aggregate_with_highest_triangulated_vertex()
 {
-    hierarchy.clear();
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        v->setWeight(v->getNumberEdge());
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-   // QSequentialAnimationGroup * group_anim = new QSequentialAnimationGroup;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        //get a neighbour
-        quint32 no_neighbour = selected->getNumberEdge();
-        if (no_neighbour == 0) // if there is no neighbour, declare a winner
-        {
-            winners.append(selected);
-            players.removeOne(selected);
-            t++;
-        }
-        else // else absorb
-        {
-            Edge * e = selected->getMostMutualVertex();
-            Vertex * neighbour, * winner, * loser;
-            if (e->toVertex() == selected)
-                neighbour = e->fromVertex();
-            else
-                neighbour = e->toVertex();
-
-            if (selected == neighbour)
-            {   qDebug() << "BUG CHECK" << "SELECTED POINTER == NEIGHBOUR POINTER";
-                return;
-            }
-            quint64 u_w = selected->getWeight(), v_w = neighbour->getWeight();
-            if (u_w >= v_w)
-            {
-                winner = selected;
-                loser = neighbour;
-            }
-            else
-            {
-                winner = neighbour;
-                loser = selected;
-            }
-            winner->absorb_removeEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            players.removeOne(loser);
-            t++;
-        }
-    }
-    record_time_and_number_of_cluster(RandomAgg::III_c,t0.elapsed(),winners.size());
-    centroids = winners;
-    qDebug("III.c - Time elapsed: %d ms", t0.elapsed());
-    large_graph_parse_result();
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::MostMutualNeighbour,
+                       AggPolicy::HigherWeightWins, AggPolicy::Destructive> Rule;
+    run_aggregator<Rule>(RandomAgg::III_c, "III.c");
 }
 
 // ---------------------------------------- AGGREGATION WHITE RETAINING VERTEX -----------------------------
 
 
-/** Reconstruct IIIa graph
- * @brief Graph::reconstructGraphRecursiveIIIa
- * @param QList<quint32> roots: an array of roots
- * create a new graph G1 which is a vertex-induced subgraph of G0
- * vertices of G1 is root
- */
-void Graph::reconstructGraphRecursiveIIIa(QList<quint32> &roots)
-{
-    //reset all params
-    LARGE_hard_reset();
-    //roots into new vertex
-    QSet<quint32> unique_roots = roots.toSet();
-    for(int i = 0; i < roots.size(); i++)
-    {
-        Vertex * v = new Vertex;
-        v->setIndex(roots.at(i));
-        myVertexList.append(v);
-    }
-    roots.clear();
-    //recreating edges
-    QDir dir(globalDirPath);
-    QStringList filters;
-    filters << "*.txt";
-    QFileInfoList file = dir.entryInfoList(filters);
-    QString e_file;
-    for (int i = 0; i < file.size(); i++)
-    {
-        QFileInfo f = file.at(i);
-        QString name = f.fileName();
-        if (name.contains("edge"))
-            e_file = f.absoluteFilePath();
-    }
-    //Parsing
-    QFile efile(e_file);
-    if (!efile.exists())
+/** Reconstruct IIIa graph
+ * @brief Graph::reconstructGraphRecursiveIIIa
+ * @param roots: one root per component of the last III.a run, see IIIaFindRoot
+ * create a new graph G1 which is a vertex-induced subgraph of G0
+ * vertices of G1 is root, root i becomes vertex i, and the edges of G0 between
+ * two roots are kept in their order. Built in memory from the current edges
+ * rather than by reloading the edge file, whose ids only match the first level: O(n + m)
+ */
+void Graph::reconstructGraphRecursiveIIIa(const QList<quint32> &roots)
+{
+    const quint32 NONE = 0xFFFFFFFF;
+    std::vector<quint32> position(myVertexList.size(), NONE);
+    for (int i = 0; i < roots.size(); i++)
+        position[roots.at(i)] = i;
+    //edges between two roots, relabelled
+    std::vector<QPair<quint32,quint32> > induced;
+    for (int i = 0; i < myEdgeList.size(); i++)
     {
-        qDebug() << "FILE NOT FOUND! Recheck! Terminating ...";
-        return;
+        Edge * e = myEdgeList.at(i);
+        quint32 a = position[e->fromVertex()->getIndex()],
+                b = position[e->toVertex()->getIndex()];
+        if (a == NONE || b == NONE || a == b) continue;
+        induced.push_back(qMakePair(a, b));
     }
-    //else
-    efile.open(QFile::ReadOnly | QFile::Text);
-    QTextStream ein(&efile);
-    QList<QPair<quint32,quint32> > edge;
-    ein.readLine(); //skip first line
-    while (!ein.atEnd())
+    //reset all params
+    LARGE_hard_reset();
+    //roots into new vertex
+    for(int i = 0; i < roots.size(); i++)
     {
-        QStringList str = ein.readLine().split('\t');
-        if(str[0].startsWith("#")) continue;
-        bool ok;
-        quint32 v1 = str[0].toUInt(&ok), v2 = str[1].toUInt(&ok);
-        if (ok)
-        {
-            edge.append(qMakePair(v1,v2));
-        }
+        Vertex * v = new Vertex;
+        v->setIndex(i);
+        myVertexList.append(v);
     }
-    efile.close();
-    //reload original vertices
-    //create Vertex and Edge object
-    qDebug() << "- Now Loading Edges ...";
-    int edge_no = 0;
-    for (int i = 0; i < edge.size(); i++)
+    //recreating edges
+    for (size_t i = 0; i < induced.size(); i++)
     {
-        QPair<quint32,quint32> p = edge[i];
-        quint32 from = p.first, to = p.second;
-        if (!unique_roots.contains(from) || !unique_roots.contains(to))
-                continue;
-        Vertex * vfrom, * vto;
-        for (int j = 0; j < myVertexList.size(); j++)
-        {
-            Vertex * v = myVertexList.at(j);
-            if (v->getIndex() == from)  vfrom = v;
-            else if (v->getIndex() == to) vto = v;
-        }
-        Edge * e = new Edge(vfrom, vto, edge_no);
-        edge_no++;
+        Vertex * vfrom = myVertexList.at(induced[i].first);
+        Vertex * vto = myVertexList.at(induced[i].second);
+        Edge * e = new Edge(vfrom, vto, i);
         myEdgeList.append(e);
     }
-    edge.clear();
-    //finally, reindex vertices
-    for (int i = 0; i < myVertexList.size(); i++)   myVertexList.at(i)->setIndex(i);
     graphIsReady = true;
     qDebug() << "Current No of Edge: " << myEdgeList.size();
 }
 
 /**
  * @brief Graph::IIIaFindRoot
- * @param roots: list of roots which will be appended
+ * @param roots: list of roots which will be appended, one per component in order of its first vertex
  * As each component is an unicyclic, if it is a perfect cycle i.e. 1->2->3->4->1, pick 1 u.a.r
  * else return the one with in-degree 2 i.e. 1->2->3->4->3, return 3
+ * Components come from a union-find over the hierarchy and the roots from one
+ * pass over a degree array, so large_result is not walked
  * @param: degreeType: 1. for in-degree of component
  * 2. for graph degree
  */
 void Graph::IIIaFindRoot(QList<quint32> &roots, int degreeType)
 {
-     //initialise degree array
-    QList<int> selectiveDegree;
-    for (int i = 0; i < myVertexList.size(); i++)   selectiveDegree << 0;
-    //count indegree
+    const quint32 NONE = 0xFFFFFFFF;
+    quint32 n = myVertexList.size();
+    //initialise degree array
+    std::vector<quint32> selectiveDegree(n, 0);
+    DisjointSet clusters(n);
     for (int i = 0; i < hierarchy.size(); i++)
     {
         QPair<quint32,quint32> p = hierarchy.at(i);
+        clusters.unite(p.first, p.second);
         if (degreeType == 1)   selectiveDegree[p.second]++; //in-degree from the component
-        else if (degreeType == 2)
-        { //degree = graph degree
-            //get the graph degree of vertex
-            int graphDegree = myVertexList.at(p.first)->getNumAdj();
-            selectiveDegree[p.first] = graphDegree;
-        }
+        else if (degreeType == 2)   selectiveDegree[p.first] = myVertexList.at(p.first)->getNumAdj(); //graph degree
     }
-    //for each clusters look for root which is a vertex of indegree 2
-    //otherwise pick 1 u.a.r
-    for (int i = 0; i < large_result.size(); i++)
+    //for each clusters keep the vertex of highest degree
+    //the k-th vertex to tie replaces it with probability 1/k, i.e. ties are picked u.a.r
+    std::vector<quint32> best(n, NONE), ties(n, 0);
+    for (quint32 v = 0; v < n; v++)
     {
-        QList<quint32> component = large_result.at(i);
-        int highest_deg = 0;
-        QList<int> highest_deg_index;
-        bool hasRoot = false; //hasRoot: has proper root of indegree 2
-        for (int j = 0; j < component.size(); j++)
+        quint32 c = clusters.find(v);
+        if (best[c] == NONE || selectiveDegree[v] > selectiveDegree[best[c]])
         {
-            quint32 v_index = component.at(j);
-            //check indegree of v
-            int v_deg = selectiveDegree[v_index];
-            if (v_deg > highest_deg)
-            {
-                highest_deg = v_deg;
-                highest_deg_index.clear();
-                highest_deg_index.append(v_index);
-            }
-            else if (v_deg == highest_deg)  highest_deg_index.append(v_deg);
+            best[c] = v;
+            ties[c] = 1;
         }
-        if (highest_deg_index.size() == 1)  roots.append(highest_deg_index[0]);
-        else
+        else if (selectiveDegree[v] == selectiveDegree[best[c]])
         {
-            //a cycle, return 1 u.a.r
-            quint32 size = highest_deg_index.size();
-            std::uniform_int_distribution<quint32> distribution(0,size-1);
-            quint32 v_ran = distribution(generator);
-            roots.append(highest_deg_index.at(v_ran));
+            ties[c]++;
+            if (Rng::global().bounded(ties[c]) == 0)    best[c] = v;
+        }
+    }
+    //list the roots in order of first vertex, clearing each once it is listed
+    for (quint32 v = 0; v < n; v++)
+    {
+        quint32 c = clusters.find(v);
+        if (best[c] != NONE)
+        {
+            roots.append(best[c]);
+            best[c] = NONE;
         }
     }
     assert(roots.size() == large_result.size()  && ("Number of Roots and Number of Components Do Not Match!"));
@@ -2728,22 +2446,14 @@ void Graph::IIIaFindRoot(QList<quint32> &roots, int degreeType)
  * Do IIIa recursively
  * V <- V'; then do III.a, let the results set be C
  * C <- V'; and so on.
+ * @param saveSnapshots: write every level's graph (G_i) and components (G_comp_i) to globalDirPath
  */
-void Graph::recursive_IIIa()
+void Graph::recursive_IIIa(const bool &saveSnapshots)
 {
     QList<quint32> roots;
     int iteration = 0;
     while (true)
     {
-        //prepare graph
-        if (!graphIsReady)
-        {
-            reconstructGraphRecursiveIIIa(roots);
-            if (myEdgeList.size() == 0) break;
-            //save snap shot after one is done i.e. G1
-            QString toSaveFilePath = "G_" + QString::number(iteration) + ".txt" ;
-            save_current_run_as_edge_file(toSaveFilePath);
-        }
         //do IIIa
         qDebug() << "Current Graph:";
         qDebug() << "no Vertex: " << myVertexList.size() << " -- no Edge:" << myEdgeList.size();
@@ -2761,10 +2471,21 @@ void Graph::recursive_IIIa()
         //maybe if there is no edge
         if(roots.size() <= 4)    break;
         iteration++;
-        QString componentFilePath = "G_comp_" + QString::number(iteration) + ".txt" ;
-        save_hierarchy_tree(componentFilePath);
+        if (saveSnapshots)
+        {
+            QString componentFilePath = "G_comp_" + QString::number(iteration) + ".txt" ;
+            save_hierarchy_tree(componentFilePath);
+        }
+        //prepare graph
+        reconstructGraphRecursiveIIIa(roots);
+        if (myEdgeList.size() == 0) break;
+        //save snap shot after one is done i.e. G1
+        if (saveSnapshots)
+        {
+            QString toSaveFilePath = "G_" + QString::number(iteration) + ".txt" ;
+            save_current_run_as_edge_file(toSaveFilePath);
+        }
     }
-    //prepare graph
 }
 
 /**
@@ -2779,47 +2500,24 @@ void Graph::IIIa_triangulation_k_max_neighbours(const int &k)
     {
         reConnectGraph();
     }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    quint32 t = 0;
     QTime t0;
     t0.start();
-
-    while(!players.empty()) //start
+    //the graph is not changed, so every vertex picks its k neighbours independently
+    std::vector<QList<Edge*> > kMaxNeighbour;
+    batch_k_most_mutual_neighbours(k, kMaxNeighbour);
+    for (int v = 0; v < myVertexList.size(); v++)
     {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        Vertex * neighbour, * winner, * loser;
-        if (selected->getNumberEdge() == 0)
+        Vertex * selected = myVertexList.at(v);
+        if (kMaxNeighbour[v].empty())
         {
-            winner = selected;
-            loser = selected;
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
+            hierarchy.append(qMakePair(selected->getIndex(), selected->getIndex()));
+            continue;
         }
-        else
+        for (int i = 0 ; i < kMaxNeighbour[v].size(); i++)
         {
-            QList<Edge*> kMaxNeighbour;
-            selected->getKMostMutualNeighbours(kMaxNeighbour, k);
-            for (int i = 0 ; i < kMaxNeighbour.size(); i++)
-            {
-                Edge * e = kMaxNeighbour.at(i);
-                if (e->toVertex() == selected)
-                    neighbour = e->fromVertex();
-                else
-                    neighbour = e->toVertex();
-
-                winner = neighbour;
-                loser = selected;
-                //create the animation
-                //winner->absorb_retainEdge(e);
-                hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            }
+            Vertex * winner = selected->get_neighbour_fromEdge(kMaxNeighbour[v].at(i));
+            hierarchy.append(qMakePair(selected->getIndex(), winner->getIndex()));
         }
-        players.removeOne(loser);
-        t++;
     }
     record_time_and_number_of_cluster(RandomAgg::III_a,t0.elapsed(),0); // the number of cluster is only determine later on
     qDebug("III.a - Time elapsed: %d ms", t0.elapsed());
@@ -2844,50 +2542,28 @@ void Graph::IIIa_triangulation_j_from_k_max_neighbours(const int &j, const int &
     {
         reConnectGraph();
     }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    quint32 t = 0;
     QTime t0;
     t0.start();
-
-    while(!players.empty()) //start
+    std::vector<QList<Edge*> > kMaxNeighbour;
+    batch_k_most_mutual_neighbours(k, kMaxNeighbour);
+    for (int v = 0; v < myVertexList.size(); v++)
     {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        Vertex * neighbour, * winner, * loser;
-        if (selected->getNumberEdge() == 0)
+        Vertex * selected = myVertexList.at(v);
+        QList<Edge*> &candidates = kMaxNeighbour[v];
+        if (candidates.empty())
         {
-            winner = selected;
-            loser = selected;
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
+            hierarchy.append(qMakePair(selected->getIndex(), selected->getIndex()));
+            continue;
         }
-        else
+        //partial Fisher-Yates: the first j candidates become a uniform j-subset
+        int picks = qMin(j, candidates.size());
+        for (int i = 0; i < picks; i++)
         {
-            QList<Edge*> kMaxNeighbour;
-            selected->getKMostMutualNeighbours(kMaxNeighbour, k);
-            for (int i = 0; i < j; i++)
-            {
-                std::uniform_int_distribution<quint32> dis(0,kMaxNeighbour.size()-1);
-                quint32 ran = dis(generator);
-                Edge * e = kMaxNeighbour.at(ran);
-                kMaxNeighbour.removeAt(ran);
-                if (e->toVertex() == selected)
-                    neighbour = e->fromVertex();
-                else
-                    neighbour = e->toVertex();
-
-                winner = neighbour;
-                loser = selected;
-                //create the animation
-                //winner->absorb_retainEdge(e);
-                hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            }
+            quint32 ran = i + Rng::global().bounded(candidates.size() - i);
+            candidates.swap(i, ran);
+            Vertex * winner = selected->get_neighbour_fromEdge(candidates.at(i));
+            hierarchy.append(qMakePair(selected->getIndex(), winner->getIndex()));
         }
-        players.removeOne(loser);
-        t++;
     }
     record_time_and_number_of_cluster(RandomAgg::III_a,t0.elapsed(),0); // the number of cluster is only determine later on
     qDebug("III.a - Time elapsed: %d ms", t0.elapsed());
@@ -2909,53 +2585,9 @@ void Graph::IIIa_triangulation_j_from_k_max_neighbours(const int &j, const int &
  */
 void Graph::random_aggregate_retain_vertex_using_triangulation()
 {
-    hierarchy.clear();
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        Vertex * neighbour, * winner, * loser;
-        if (selected->getNumberEdge() == 0)
-        {
-            winner = selected;
-            loser = selected;
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-        }
-        else
-        {
-            Edge * e = selected->getMostMutualVertex();
-            if (e->toVertex() == selected)
-                neighbour = e->fromVertex();
-            else
-                neighbour = e->toVertex();
-
-            winner = neighbour;
-            loser = selected;
-            //create the animation
-            winner->absorb_retainEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-        }
-        players.removeOne(loser);
-        t++;
-    }
-    record_time_and_number_of_cluster(RandomAgg::III_a,t0.elapsed(),0); // the number of cluster is only determine later on
-    qDebug("III.a - Time elapsed: %d ms", t0.elapsed());
-    large_parse_retain_result();
-    //time is recorded first
-    record_time_and_number_of_cluster(RandomAgg::III_a,0,large_result.size());
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::MostMutualNeighbour,
+                       AggPolicy::NeighbourWins, AggPolicy::Retentive> Rule;
+    run_aggregator<Rule>(RandomAgg::III_a, "III.a");
 }
 
 /** Type III.z - Probabilistic Triangulation using Colin's definition of triang
@@ -2965,7 +2597,7 @@ void Graph::random_aggregate_retain_vertex_using_triangulation()
  * Let CT(v) be this index,
  * for every v: choose u: arg max CT(u)
  * if CT(v) is max, points to self
- *  %%%% UNOPTIMISED %%%%%%
+ * CT is counted for all vertices at once, see count_vertex_triangles()
  * @brief Graph::random_aggregate_retain_vertex_using_colin_triangulation
  */
 void Graph::random_aggregate_retain_vertex_using_colin_triangulation()
@@ -2977,12 +2609,7 @@ void Graph::random_aggregate_retain_vertex_using_colin_triangulation()
     }
     //initialise arrays
     //count Colin's Triangles - preprocessing
-    QList<quint32> tri;
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-        tri.append(v->getNumberOfColinTriangles());
-    }
+    const std::vector<quint32> &tri = count_vertex_triangles();
     //doing actual work, directing edges
     QTime t0;
     t0.start();
@@ -3009,12 +2636,11 @@ void Graph::random_aggregate_retain_vertex_using_colin_triangulation()
         }
         //selecting one with highest CT()
         if (CT_v >= highest_tri)            hierarchy.append(qMakePair(i, i)); //root
-        else if (dup_max_tri.size() == 1)   hierarchy.append(qMakePair(i, dup_max_tri[0])); //directed edge
+        else if (dup_max_tri.size() == 1)   hierarchy.append(qMakePair(i, adj_v[dup_max_tri[0]])); //directed edge
         else if (dup_max_tri.size() > 1)
         {
-            std::uniform_int_distribution<quint32> distribution(0,dup_max_tri.size()-1);
-            quint32 selected = distribution(generator);
-            hierarchy.append(qMakePair(i, dup_max_tri[selected]));
+            quint32 selected = Rng::global().bounded(dup_max_tri.size());
+            hierarchy.append(qMakePair(i, adj_v[dup_max_tri[selected]]));
         }
     }
     record_time_and_number_of_cluster(RandomAgg::III_z,t0.elapsed(),0); // the number of cluster is only determine later on
@@ -3032,50 +2658,9 @@ void Graph::random_aggregate_retain_vertex_using_colin_triangulation()
  */
 void Graph::random_aggregate_retain_vertex_using_probabilistic_triangulation()
 {
-    hierarchy.clear();
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        if (selected->getNumberEdge() == 0)
-            players.removeOne(selected);
-        else
-        {
-            Edge * e = selected->getProbabilisticTriangulationCoeffVertex();
-            Vertex * neighbour, * winner, * loser;
-            if (e->toVertex() == selected)
-                neighbour = e->fromVertex();
-            else
-                neighbour = e->toVertex();
-            winner = neighbour;
-            loser = selected;
-            winner->absorb_retainEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            players.removeOne(loser);
-        }
-        t++;
-    }
-    record_time_and_number_of_cluster(RandomAgg::III_b,t0.elapsed(),0); // the number of cluster is only determine later on
-    qDebug("III.b - Time elapsed: %d ms", t0.elapsed());
-    large_parse_retain_result();
-    //time is recorded first
-    record_time_and_number_of_cluster(RandomAgg::III_b,0,large_result.size());
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::TriangleBiasedNeighbour,
+                       AggPolicy::NeighbourWins, AggPolicy::Retentive> Rule;
+    run_aggregator<Rule>(RandomAgg::III_b, "III.b");
 }
 
 
@@ -3088,64 +2673,9 @@ void Graph::random_aggregate_retain_vertex_using_probabilistic_triangulation()
  */
 void Graph::random_aggregate_retain_vertex_using_triangulation_times_weight()
 {
-    hierarchy.clear();
-    if (!checkGraphCondition())
-    {
-        reConnectGraph();
-    }
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        Vertex * v = myVertexList.at(i);
-       // v->setWeight(v->getNumberEdge());
-        v->setWeight(1);
-    }
-    //initialise arrays
-    QList<Vertex*> players = myVertexList;
-    QList<Vertex*> winners;
-    quint32 t = 0;
-    QTime t0;
-    t0.start();
-
-    while(!players.empty()) //start
-    {
-        //select a vertex uniformly at random
-        quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-
-        quint32 selected_index = distribution(generator);
-        Vertex * selected = players.at(selected_index);
-        if (selected->getNumberEdge() == 0)
-            players.removeOne(selected);
-        else
-        {
-            Edge * e = selected->getProbabilisticTriangulationAndWeightVertex();
-            if (e == 0)
-            {
-                selected->setParent(selected);
-                players.removeOne(selected);
-                continue;
-            }
-            Vertex * neighbour, * winner, * loser;
-            if (e->toVertex() == selected)
-                neighbour = e->fromVertex();
-            else
-                neighbour = e->toVertex();
-
-            winner = neighbour;
-            loser = selected;
-            //create the animation
-            winner->absorb_retainEdge(e);
-            hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
-            players.removeOne(loser);
-        }
-        t++;
-    }
-    record_time_and_number_of_cluster(RandomAgg::III_d,t0.elapsed(),0); // the number of cluster is only determine later on
-    qDebug("III.d - Time elapsed: %d ms", t0.elapsed());
-    large_parse_retain_result();
-    //time is recorded first
-    record_time_and_number_of_cluster(RandomAgg::III_d,0,large_result.size());
-
+    typedef Aggregator<AggPolicy::UniformCandidate, AggPolicy::TriangleTimesWeightNeighbour,
+                       AggPolicy::NeighbourWins, AggPolicy::Retentive> Rule;
+    run_aggregator<Rule>(RandomAgg::III_d, "III.d");
 }
 
 /** Type III.e - Highest Tri(Cluster)
@@ -3171,19 +2701,21 @@ void Graph::random_aggregate_retain_vertex_using_triangulation_of_cluster()
     quint32 t = 0;
     QTime t0;
     t0.start();
+    //edges are retained: triangles per edge are counted once, clusters live in a union-find
+    const std::vector<quint32> &support = count_edge_support();
+    DisjointSet clusters(myVertexList.size());
 
     while(!players.empty()) //start
     {
         //select a vertex uniformly at random
         quint32 size = players.size();
-        std::uniform_int_distribution<quint32> distribution(0,size-1);
-        quint32 selected_index = distribution(generator);
+        quint32 selected_index = Rng::global().bounded(size);
         Vertex * selected = players.at(selected_index);
         if (selected->getNumberEdge() == 0)
             players.removeOne(selected);
         else
         {
-            Edge * e = selected->getHighestTriangulateCluster();
+            Edge * e = selected->getHighestTriangulateCluster(clusters, support);
             Vertex * neighbour, * winner, * loser;
             if (e->toVertex() == selected)
                 neighbour = e->fromVertex();
@@ -3196,6 +2728,11 @@ void Graph::random_aggregate_retain_vertex_using_triangulation_of_cluster()
             winner->absorb_retainEdge(e);
             hierarchy.append(qMakePair(loser->getIndex(), winner->getIndex()));
             players.removeOne(loser);
+            //closing a cycle makes the winner the centroid, otherwise the winner's centroid is kept
+            bool cycle = clusters.find(loser->getIndex()) == clusters.find(winner->getIndex());
+            clusters.unite(loser->getIndex(), winner->getIndex());
+            if (cycle)
+                clusters.setLabel(winner->getIndex(), winner->getIndex());
         }
         t++;
     }
@@ -3455,6 +2992,7 @@ void Graph::read_large_ground_truth_communities()
 {
     qDebug() << "PARSING GROUND TRUTH COMMUNITIES";
     ground_truth_communities.clear();
+    overlapping_ground_truth.clear();
     QString filePath;
     QFile file(filePath);
     file.open(QFile::ReadOnly | QFile::Text);
@@ -3759,6 +3297,7 @@ void Graph::read_DUMEX_input(QString dirPath)
         graphIsReady = true;
         qDebug() << "PREQUISITE: OK! READING TRUTH FILES";
         ground_truth_communities.clear();
+        overlapping_ground_truth.clear();
         QFile tfile(t_file);
         tfile.open(QFile::ReadOnly | QFile::Text);
         QTextStream tin(&tfile);
@@ -3821,6 +3360,7 @@ void Graph::read_DUMEX_input(QString dirPath)
         }
         qDebug() << "Number of Vertex Excluded From SNAP Community:" << large_excluded.size();
         qDebug() << "Removing Overlap (By Assigning each vertex to the largest)";
+        overlapping_ground_truth = ground_truth_communities;
         large_process_overlap();
         graphIsReady = true;
     }
@@ -3985,6 +3525,22 @@ void Graph::print_result_stats()
     qDebug() << " - DONE!!!";
 }
 
+/** Row names of t_and_c_log.txt, in RandomAgg order
+ * @brief time_and_number_of_cluster_types
+ * @return
+ */
+static QStringList time_and_number_of_cluster_types()
+{
+    QStringList types;
+    types << "I.a"<< "I.b"<< "I.c"
+          << "II.a"<< "II.a.i"<< "II.b"<< "II.b.i"<< "II.c"<< "II.d"<< "II.e"<< "II.f"<< "II.g"<< "II.h"
+          << "III.a"<< "III.b"<< "III.c"<< "III.d"<< "III.e"
+          << "GN_Clustering"<< "CNM_Clustering"
+          << "R1a"<<"I_x"<< "RFD" << "III.z" << "Louvain" << "Leiden" << "LPA"
+          << "Parallel_I.a" << "Parallel_I.b" << "Parallel_I.c";
+    return types;
+}
+
 /** CREATE THIS LOG FILE
  * @brief Graph::create_time_and_number_of_cluster_file
  * the matrix format is:
@@ -3999,12 +3555,7 @@ void Graph::create_time_and_number_of_cluster_file()
     file.open(QIODevice::WriteOnly | QIODevice::Text);
     QTextStream out(&file);
     out << "Type \t average_t(msec) \t average_c \n";
-    QStringList types;
-    types << "I.a"<< "I.b"<< "I.c"
-          << "II.a"<< "II.a.i"<< "II.b"<< "II.b.i"<< "II.c"<< "II.d"<< "II.e"<< "II.f"<< "II.g"<< "II.h"
-          << "III.a"<< "III.b"<< "III.c"<< "III.d"<< "III.e"
-          << "GN_Clustering"<< "CNM_Clustering"
-          << "R1a"<<"I_x"<< "RFD" << "III.z";
+    QStringList types = time_and_number_of_cluster_types();
     for(int i = 0; i < types.size(); i++)
     {
         out << types[i] << '\t' << QString::number(0) << '\t' << QString::number(0) << '\n';
@@ -4029,8 +3580,22 @@ void Graph::record_time_and_number_of_cluster(int AlgorithmType, int t, int c)
     QTextStream in(&outFile);
     int id = AlgorithmType + 1; //first line is skipped
     QStringList types = in.readAll().split('\n');
+    //a log written before the newer types were added lacks their rows
+    QStringList names = time_and_number_of_cluster_types();
+    if (id < 1 || id > names.size())
+    {
+        qDebug() << "- Unknown Type For t_and_c_log.txt:" << AlgorithmType;
+        outFile.close();
+        return;
+    }
+    while (types.size() > 1 && types.last().isEmpty())
+        types.removeLast();
+    for (int i = types.size(); i <= names.size(); i++)
+        types.append(names.at(i - 1) + "\t0\t0");
     QString record = types.at(id); //whole record
     QStringList t_and_c = record.split('\t'); //get a type record
+    if (t_and_c.size() < 3)
+        t_and_c = QString(names.at(id - 1) + "\t0\t0").split('\t');
     //start rewriting
     int prev_t = t_and_c.at(1).toInt(),
         prev_c = t_and_c.at(2).toInt();
@@ -4590,33 +4155,26 @@ QList<double> Graph::LARGE_compute_Pairwise_efficient(int n)
     quint64 n_minus_1 = n-1, n_times_n_minus = n*n_minus_1;
     n_choose_2 = n_times_n_minus/2;
 
-    int row = ground_truth_communities.size(), column = large_result.size();
-    std::vector<quint64> ni, nj; //ni: sum row, nj: sum column
-    for(size_t j = 0; j < column; j++)
-        nj.push_back(0);
-
-    for (size_t i = 0; i < row; i++)
-    {
-        quint64 sum_row = 0;
-        QList<quint32> X = ground_truth_communities[i];
-        for (int j = 0; j < column; j++)
-        {
-            QList<quint32> Y = large_result[j];
-            uint32 entry = X.toSet().intersect(Y.toSet()).size(); //sets are assumed to be sorted
-            quint64 entry_square = entry*entry,
-                   entry_entryminus = entry*(entry-1);
-            nij_minus += entry_entryminus; // nij(nij-1)
-            nij_square += entry_square; // nij^2
-            nij_choose_2 += entry_entryminus/2; //(nij choose 2) for adjust rand
-            nij += entry;
-            sum_row += entry;
-            //
-            quint64 sum_col = nj[j];
-            quint64 new_sum = entry + sum_col;
-            nj[j] = new_sum;
-        }
-        ni.push_back(sum_row);
+    //only the non-zero entries of the row x column matrix, see build_contingency_table
+    ContingencyTable table;
+    build_contingency_table(table);
+    qint64 cells = table.getNumberOfCells();
+    #pragma omp parallel for reduction(+:nij_minus,nij_square,nij_choose_2,nij)
+    for (qint64 k = 0; k < cells; k++)
+    {
+        quint64 entry = table.cellCount(k);
+        quint64 entry_square = entry*entry,
+               entry_entryminus = entry*(entry-1);
+        nij_minus += entry_entryminus; // nij(nij-1)
+        nij_square += entry_square; // nij^2
+        nij_choose_2 += entry_entryminus/2; //(nij choose 2) for adjust rand
+        nij += entry;
     }
+    std::vector<quint64> ni, nj; //ni: sum row, nj: sum column
+    for (quint32 i = 0; i < table.getNumberOfRows(); i++)
+        ni.push_back(table.rowSum(i));
+    for (quint32 j = 0; j < table.getNumberOfColumns(); j++)
+        nj.push_back(table.columnSum(j));
 
     quint64 n_square = 0,
             ni_sum = 0, //sum row
@@ -4695,6 +4253,147 @@ QList<double> Graph::LARGE_compute_Pairwise_efficient(int n)
 }
 
 
+/** Rows are the ground truth communities, columns the result clusters.
+ * A vertex in several ground truth communities is counted in the last one.
+ * Without a loaded ground truth and l > 0, vertex v is taken to be in row v/l
+ * (planted partitions of l vertices per community)
+ * @brief Graph::build_contingency_table
+ * @param table
+ * @param l
+ */
+void Graph::build_contingency_table(ContingencyTable &table, const int &l)
+{
+    quint32 n = myVertexList.size();
+    for (int i = 0; i < ground_truth_communities.size(); i++)
+        for (int k = 0; k < ground_truth_communities.at(i).size(); k++)
+            n = qMax(n, ground_truth_communities.at(i).at(k) + 1);
+    for (int j = 0; j < large_result.size(); j++)
+        for (int k = 0; k < large_result.at(j).size(); k++)
+            n = qMax(n, large_result.at(j).at(k) + 1);
+    std::vector<quint32> truth(n, ContingencyTable::NO_LABEL), result(n, ContingencyTable::NO_LABEL);
+    quint32 rows = ground_truth_communities.size();
+    if (rows == 0 && l > 0)
+    {
+        for (quint32 v = 0; v < n; v++)
+            truth[v] = v/l;
+        rows = (n + l - 1)/l;
+    }
+    for (int i = 0; i < ground_truth_communities.size(); i++)
+        foreach (quint32 v, ground_truth_communities.at(i))
+            truth[v] = i;
+    for (int j = 0; j < large_result.size(); j++)
+        foreach (quint32 v, large_result.at(j))
+            result[v] = j;
+    table.build(truth, rows, result, large_result.size());
+}
+
+/** Information theoretic comparison of the result with the ground truth, all from
+ * one sparse contingency table: NMI normalised by the arithmetic and by the
+ * geometric mean of the entropies, Variation of Information (nats) and purity
+ * @brief Graph::LARGE_compute_information_measures
+ * @return NMI (arithmetic), NMI (geometric), VI, purity
+ */
+QList<double> Graph::LARGE_compute_information_measures()
+{
+    QList<double> result;
+    if (ground_truth_communities.empty() || large_result.empty())
+    {
+        qDebug() << "GROUND TRUTH COMMUNITIES HAS NOT BEEN LOADED OR GRAPH HAS NOT BEEN CLUSTERED";
+        return result;
+    }
+    ContingencyTable table;
+    build_contingency_table(table);
+    double nmi = table.nmiArithmetic(), nmi_sqrt = table.nmiGeometric(),
+            vi = table.variationOfInformation(), purity = table.purity();
+    printf("NMI: %f\tNMI(sqrt): %f\tVI: %f\tPurity: %f\n", nmi, nmi_sqrt, vi, purity);
+    result.push_back(nmi);
+    result.push_back(nmi_sqrt);
+    result.push_back(vi);
+    result.push_back(purity);
+    return result;
+}
+
+/** Compare the result with the ground truth as it was read, i.e. before the
+ * overlaps were resolved: average best-match F1 and overlapping NMI (LFK and
+ * max normalised). Vertices excluded from the ground truth are not counted in n
+ * @brief Graph::LARGE_compute_overlapping_measures
+ * @return F1, ONMI (LFK), ONMI (max)
+ */
+QList<double> Graph::LARGE_compute_overlapping_measures()
+{
+    QList<double> result;
+    const QList<QList<quint32> > &truth = overlapping_ground_truth.empty() ? ground_truth_communities
+                                                                         : overlapping_ground_truth;
+    if (truth.empty() || large_result.empty())
+    {
+        qDebug() << "GROUND TRUTH COMMUNITIES HAS NOT BEEN LOADED OR GRAPH HAS NOT BEEN CLUSTERED";
+        return result;
+    }
+    OverlapScore score;
+    score.build(truth, large_result, myVertexList.size() - large_excluded.size());
+    double f1 = score.averageF1(), onmi = score.onmiLFK(), onmi_max = score.onmiMax();
+    printf("F1: %f\tONMI(LFK): %f\tONMI(max): %f\n", f1, onmi, onmi_max);
+    result.push_back(f1);
+    result.push_back(onmi);
+    result.push_back(onmi_max);
+    return result;
+}
+
+/** RAND, Jaccard and ARI after every step of the hierarchy, replayed on a
+ * union-find from singletons (see PairCountTracker). A vertex in several ground
+ * truth communities is counted in the last one, excluded vertices are left out.
+ * One "step RAND Jaccard ARI" line per `every` steps, and the last step, is
+ * written to pairwise_trace.txt
+ * @brief Graph::LARGE_compute_Pairwise_trace
+ * @param every
+ * @return RAND, Jaccard, ARI of the whole hierarchy
+ */
+QList<double> Graph::LARGE_compute_Pairwise_trace(const quint32 &every)
+{
+    QList<double> result;
+    if (ground_truth_communities.empty())
+    {
+        qDebug() << "GROUND TRUTH COMMUNITIES HAS NOT BEEN LOADED";
+        return result;
+    }
+    quint32 n = myVertexList.size();
+    std::vector<quint32> truth(n, PairCountTracker::NO_LABEL);
+    for (int i = 0; i < ground_truth_communities.size(); i++)
+        foreach (quint32 v, ground_truth_communities.at(i))
+            if (v < n && !large_excluded.contains(v))   truth[v] = i;
+    PairCountTracker tracker;
+    tracker.reset(truth);
+    DisjointSet clusters(n);
+    QFile file(globalDirPath + "/pairwise_trace.txt");
+    bool write = file.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream out(&file);
+    if (write)
+        out << "step\tRAND\tJaccard\tARI\n";
+    quint32 step = qMax(every, (quint32) 1);
+    for (int i = 0; i <= hierarchy.size(); i++)
+    {
+        if (i > 0)
+        {
+            quint32 a = clusters.find(hierarchy.at(i-1).first), b = clusters.find(hierarchy.at(i-1).second);
+            if (a != b)
+            {
+                quint32 root = clusters.unite(a, b);
+                tracker.merge(root, root == a ? b : a);
+            }
+        }
+        if (write && (i % step == 0 || i == hierarchy.size()))
+            out << i << '\t' << tracker.rand() << '\t' << tracker.jaccard() << '\t' << tracker.adjustedRand() << '\n';
+    }
+    if (write)
+        file.close();
+    double RAND = tracker.rand(), Jaccard = tracker.jaccard(), ARI = tracker.adjustedRand();
+    printf("RAND: %f\tJaccard: %f\tARI: %f\n", RAND, Jaccard, ARI);
+    result.push_back(RAND);
+    result.push_back(Jaccard);
+    result.push_back(ARI);
+    return result;
+}
+
 quint64 Graph::calA(QList<quint64> param)
 {
     quint64 a = param[0];
@@ -4745,38 +4444,158 @@ double Graph::calAdRand(QList<quint64> param)
     return ARI;
 }
 
+/** Time the II.b neighbour draw: exact cumulative scan against rejection on the degree bound
+ * @brief Graph::benchmark_degree_biased_neighbour_sampling
+ * @param draws per vertex
+ */
+void Graph::benchmark_degree_biased_neighbour_sampling(const quint32 &draws)
+{
+    if (!checkGraphCondition())
+    {
+        reConnectGraph();
+    }
+    quint64 total_draws = 0, sink = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < myVertexList.size(); i++)
+    {
+        Vertex * v = myVertexList.at(i);
+        if (v->getNumberEdge() == 0)
+            continue;
+        for (quint32 j = 0; j < draws; j++)
+            sink += v->getDegreeProbabilisticEdgeByScan()->getIndex();
+        total_draws += draws;
+    }
+    qint64 scan_ns = timer.nsecsElapsed();
+    timer.restart();
+    for (int i = 0; i < myVertexList.size(); i++)
+    {
+        Vertex * v = myVertexList.at(i);
+        if (v->getNumberEdge() == 0)
+            continue;
+        for (quint32 j = 0; j < draws; j++)
+            sink += v->getDegreeProbabilisticEdge()->getIndex();
+    }
+    qint64 rejection_ns = timer.nsecsElapsed();
+    if (total_draws == 0)
+    {
+        qDebug() << "NO EDGE TO SAMPLE!";
+        return;
+    }
+    printf("- Degree biased neighbour draw (%llu draws, checksum %llu)\n"
+           "  scan:      %.2f ns/draw\n"
+           "  rejection: %.2f ns/draw\n"
+           "  speedup:   %.2fx\n",
+           (unsigned long long) total_draws, (unsigned long long) sink,
+           (double) scan_ns/total_draws, (double) rejection_ns/total_draws,
+           rejection_ns > 0 ? (double) scan_ns/rejection_ns : 0.0);
+}
+
 /** Calculate the Clustering Coeffficient, which is the average over all v
- * Watts Algorithm
+ * Watts Algorithm: C(v) = T(v) / (d(v) choose 2), 0 when d(v) < 2,
+ * with T(v) from the cached triangle counts
  * @brief Graph::cal_average_clustering_coefficient
  * @return
  */
 double Graph::cal_average_clustering_coefficient()
 {
-    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> NormalGraph;
-    NormalGraph g;
-    for (int i = 0; i < myVertexList.size(); i++)
-    {
-        boost::add_vertex(g);
+    const std::vector<quint32> &tri = count_vertex_triangles();
+    qint64 n = tri.size();
+    if (n == 0)
+        return 0.0;
+    double sum = 0.0;
+    #pragma omp parallel for reduction(+:sum)
+    for (qint64 v = 0; v < n; v++)
+    {
+        quint64 d = myTriangleCSR.degree(v);
+        if (d > 1)
+            sum += 2.0 * tri[v] / (d * (d - 1));
+    }
+    return sum / n;
+}
+
+/** Estimate of the average Clustering Coefficient over sampleNodes vertices drawn
+ * u.a.r. (with replacement), as SNAP GetClustCf(Graph, SampleNodes): only the
+ * sampled vertices have their triangles counted, on a CSR snapshot, unless the
+ * triangle cache is already up to date. sampleNodes = 0 or >= |V| gives the exact value
+ * @brief Graph::cal_average_clustering_coefficient
+ * @param sampleNodes
+ * @return
+ */
+double Graph::cal_average_clustering_coefficient(const quint32 &sampleNodes)
+{
+    qint64 n = myVertexList.size();
+    if (sampleNodes == 0 || sampleNodes >= n)
+        return cal_average_clustering_coefficient();
+    //draw first, so the estimate does not depend on the number of threads
+    std::vector<quint32> sample(sampleNodes);
+    for (quint32 i = 0; i < sampleNodes; i++)
+        sample[i] = Rng::global().bounded(n);
+    bool cached = triangles_are_current();
+    CSRGraph snapshot;
+    if (!cached)
+        build_csr(snapshot);
+    const CSRGraph &csr = cached ? myTriangleCSR : snapshot;
+    double sum = 0.0;
+    #pragma omp parallel reduction(+:sum)
+    {
+        std::vector<char> mark(cached ? 0 : n, 0);
+        #pragma omp for schedule(dynamic, 16)
+        for (qint64 i = 0; i < (qint64) sampleNodes; i++)
+        {
+            quint32 v = sample[i];
+            quint64 d = csr.degree(v);
+            if (d < 2)
+                continue;
+            quint32 t = cached ? myVertexTriangles[v] : csr.vertexTriangles(v, mark);
+            sum += 2.0 * t / (d * (d - 1));
+        }
     }
-    for(int i = 0;i  < myEdgeList.size(); i++)
+    return sum / sampleNodes;
+}
+
+/** Local Clustering Coefficient of every vertex, C(v) = T(v) / (d(v) choose 2),
+ * 0 when d(v) < 2, from the cached triangle counts
+ * @brief Graph::cal_local_clustering_coefficients
+ * @return indexed by vertex index
+ */
+std::vector<double> Graph::cal_local_clustering_coefficients()
+{
+    const std::vector<quint32> &tri = count_vertex_triangles();
+    qint64 n = tri.size();
+    std::vector<double> cc(n, 0.0);
+    #pragma omp parallel for schedule(static)
+    for (qint64 v = 0; v < n; v++)
     {
-        Edge * e = myEdgeList.at(i);
-        int from = e->fromVertex()->getIndex(), to = e->toVertex()->getIndex();
-        boost::add_edge(from,to,g);
-    }
-    // Compute the clustering coefficients of each vertex in the graph
-    // and the mean clustering coefficient which is returned from the
-    // computation.
-    typedef boost::exterior_vertex_property<NormalGraph, float> ClusteringProperty;
-    typedef ClusteringProperty::container_type ClusteringContainer;
-    typedef ClusteringProperty::map_type ClusteringMap;
-
-    ClusteringContainer coefs(boost::num_vertices(g));
-    ClusteringMap cm(coefs, g);
-    double cc = boost::all_clustering_coefficients(g, cm);
+        quint64 d = myTriangleCSR.degree(v);
+        if (d > 1)
+            cc[v] = 2.0 * tri[v] / (d * (d - 1));
+    }
     return cc;
 }
 
+/** Global Clustering Coefficient (transitivity): 3 x triangles / connected triples,
+ * i.e. sum T(v) / sum (d(v) choose 2), from the cached triangle counts
+ * @brief Graph::cal_global_clustering_coefficient
+ * @return
+ */
+double Graph::cal_global_clustering_coefficient()
+{
+    const std::vector<quint32> &tri = count_vertex_triangles();
+    qint64 n = tri.size();
+    quint64 closed = 0, triples = 0;
+    #pragma omp parallel for reduction(+:closed,triples)
+    for (qint64 v = 0; v < n; v++)
+    {
+        quint64 d = myTriangleCSR.degree(v);
+        closed += tri[v];
+        triples += d * (d - 1) / 2;
+    }
+    if (triples == 0)
+        return 0.0;
+    return (double) closed / triples;
+}
+
 
 /** Clear Log File
  * @brief Graph::clear_log
@@ -4822,8 +4641,7 @@ void Graph::random_functional_digraph()
         }
         else
         {
-            std::uniform_int_distribution<quint32> distribution2(0,dv-1);
-            quint32 selected_edge_index = distribution2(generator);
+            quint32 selected_edge_index = Rng::global().bounded(dv);
             Edge * e = selected->getEdge(selected_edge_index);
             Vertex * neighbour = selected->get_neighbour_fromEdge(e); //get the neighbour (not clean)
             hierarchy.append(qMakePair(selected->getIndex(), neighbour->getIndex()));
@@ -4892,11 +4710,62 @@ void Graph::fast_CMN()
 }
 //////////////////////////// END OF SNAP COMMUNITY ALGORITHM /////////////////////
 
+/** Louvain modularity clustering on a CSR snapshot, multithreaded (see Louvain);
+ * with refine, the Leiden variant with its refinement phase.
+ * The labels go to large_result like any aggregation, so the same scorers apply;
+ * there is no hierarchy
+ * @brief Graph::parallel_louvain
+ * @param refine
+ */
+void Graph::parallel_louvain(const bool &refine)
+{
+    if (!checkGraphCondition())
+    {
+        reConnectGraph();
+    }
+    hierarchy.clear();
+    int type = refine ? RandomAgg::Leiden_Clustering : RandomAgg::Louvain_Clustering;
+    QTime t0;
+    t0.start();
+    CSRGraph csr;
+    build_csr(csr);
+    Louvain engine;
+    engine.run(csr, refine);
+    parse_label_result(engine.getLabels());
+    record_time_and_number_of_cluster(type, t0.elapsed(), large_result.size());
+    qDebug("%s - %d levels, Q: %f, Time elapsed: %d ms", refine ? "Leiden" : "Louvain",
+           (int) engine.getNumberOfLevels(), engine.getModularity(), t0.elapsed());
+}
+
+/** Label propagation on a CSR snapshot, multithreaded (see LabelPropagation);
+ * ties are broken by the vertex Rng streams. The labels go to large_result like
+ * any aggregation, so the same scorers apply; there is no hierarchy
+ * @brief Graph::parallel_label_propagation
+ */
+void Graph::parallel_label_propagation()
+{
+    if (!checkGraphCondition())
+    {
+        reConnectGraph();
+    }
+    hierarchy.clear();
+    QTime t0;
+    t0.start();
+    CSRGraph csr;
+    build_csr(csr);
+    LabelPropagation engine;
+    engine.run(csr, 100);
+    parse_label_result(engine.getLabels());
+    record_time_and_number_of_cluster(RandomAgg::LPA_Clustering, t0.elapsed(), large_result.size());
+    qDebug("LPA - %d rounds, Time elapsed: %d ms", (int) engine.getNumberOfRounds(), t0.elapsed());
+}
+
 /** Reset to prepare for next run
  * @brief Graph::LARGE_reset
  */
 void Graph::LARGE_reset()
 {
+    Rng::beginRun();
     for (int i = 0; i < myVertexList.size(); i++)
     {
         myVertexList.at(i)->resetClusterRelevant();
@@ -5248,10 +5117,51 @@ void Graph::LARGE_hard_reset()
     hierarchy.clear();
     centroids.clear();
     large_result.clear();
+    //names vertices that are gone; the next truth loader sets it again
+    overlapping_ground_truth.clear();
     graphIsReady = false;
 }
 
 
+/** One pass over the adjacency of the clustered vertices, in parallel: every
+ * arc is internal to the cluster of its source or cut from it. Vertices outside
+ * large_result are not a source, their edges count as cut for the other end
+ * @brief Graph::count_cluster_statistics
+ * @param stats
+ */
+void Graph::count_cluster_statistics(ClusterStats &stats)
+{
+    quint32 n = myVertexList.size();
+    std::vector<quint32> clusterOf(n, ContingencyTable::NO_LABEL);
+    stats.reset(large_result.size(), global_e);
+    for (int i = 0; i < large_result.size(); i++)
+    {
+        stats.setSize(i, large_result.at(i).size());
+        foreach (quint32 v, large_result.at(i))
+            clusterOf[v] = i;
+    }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (qint64 i = 0; i < (qint64) n; i++)
+    {
+        quint32 c = clusterOf[i];
+        if (c == ContingencyTable::NO_LABEL)
+            continue;
+        Vertex * v = myVertexList.at(i);
+        //counted here first, so a vertex costs two atomics whatever its degree
+        quint64 internal = 0, cut = 0;
+        for (quint32 k = 0; k < v->getNumberEdge(); k++)
+        {
+            Vertex * other = v->get_neighbour_fromEdge(v->getEdge(k));
+            if (clusterOf[other->getIndex()] == c)
+                internal++;
+            else
+                cut++;
+        }
+        stats.addInternalArcs(c, internal);
+        stats.addCutArcs(c, cut);
+    }
+}
+
 /** Calculate Modularity
  * @brief Graph::LARGE_compute_modularity
  * @return
@@ -5265,37 +5175,170 @@ double Graph::LARGE_compute_modularity()
         LARGE_reload_edges();
     }
     global_e = myEdgeList.size();
-    //go through result
-    double Q = 0.0;
-    for (int i = 0; i < large_result.size(); i++)
+    ClusterStats stats;
+    count_cluster_statistics(stats);
+    graphIsReady = false;
+    return stats.modularity();
+}
+
+/** Size, internal and cut edges, volume, conductance and internal density of every
+ * cluster, from the same pass as the modularity. Written to cluster_stats.csv and
+ * cluster_stats.bin (see ClusterStats::writeBinary) in the working directory,
+ * the distributions are printed
+ * @brief Graph::LARGE_write_cluster_statistics
+ * @return modularity
+ */
+double Graph::LARGE_write_cluster_statistics()
+{
+    if (large_result.empty())
     {
-        QList<quint32> c = large_result[i];
-        QSet<quint32> vi = c.toSet();
-        quint64 intra = 0, inter = 0;
-        for (int j = 0; j < c.size(); j++)
+        qDebug() << "GRAPH HAS NOT BEEN CLUSTERED";
+        return 0.0;
+    }
+    if (!graphIsReady)
+    {
+        clear_edge();
+        LARGE_reload_edges();
+    }
+    global_e = myEdgeList.size();
+    ClusterStats stats;
+    count_cluster_statistics(stats);
+    graphIsReady = false;
+    stats.writeCSV(globalDirPath + "/cluster_stats.csv");
+    stats.writeBinary(globalDirPath + "/cluster_stats.bin");
+    stats.printSummary();
+    return stats.modularity();
+}
+
+/** Q after every step of the hierarchy, trace[0] being the singletons. The
+ * hierarchy is replayed on a union-find; the edges between two merging clusters
+ * are counted from the adjacency of the smaller one, so the whole trace costs
+ * O(m log n) and every step updates Q in O(1) (see ModularityTracker).
+ * Vertices excluded from the result count as in LARGE_compute_modularity
+ * @brief Graph::track_modularity
+ * @param trace
+ */
+void Graph::track_modularity(std::vector<double> &trace)
+{
+    quint32 n = myVertexList.size();
+    std::vector<bool> excluded(n, false);
+    std::vector<quint64> volume(n, 0);
+    std::vector<std::vector<quint32> > members(n);
+    for (quint32 v = 0; v < n; v++)
+    {
+        members[v].push_back(v);
+        excluded[v] = large_excluded.contains(v);
+        if (!excluded[v])
+            volume[v] = myVertexList.at(v)->getNumberEdge();
+    }
+    ModularityTracker tracker;
+    tracker.reset(volume, global_e);
+    DisjointSet clusters(n);
+    trace.clear();
+    trace.reserve(hierarchy.size() + 1);
+    trace.push_back(tracker.modularity());
+    for (int i = 0; i < hierarchy.size(); i++)
+    {
+        quint32 a = clusters.find(hierarchy.at(i).first), b = clusters.find(hierarchy.at(i).second);
+        if (a != b)
         {
-            quint32 id = c[j];
-            Vertex * v = myVertexList.at(id);
-            QList<Edge*> adj = v->getAllEdge();
-            for (int k = 0; k < adj.size(); k++)
+            if (members[a].size() > members[b].size())
+                qSwap(a, b);
+            quint64 between = 0;
+            foreach (quint32 u, members[a])
             {
-                Vertex * other = v->get_neighbour_fromEdge(adj[k]);
-                quint32 other_id = other->getIndex();
-                if (vi.contains(other_id))
-                    intra++;
-                else
-                    inter++;
+                if (excluded[u])
+                    continue;
+                Vertex * v = myVertexList.at(u);
+                for (quint32 k = 0; k < v->getNumberEdge(); k++)
+                {
+                    quint32 w = v->get_neighbour_fromEdge(v->getEdge(k))->getIndex();
+                    if (!excluded[w] && clusters.find(w) == b)
+                        between++;
+                }
             }
+            quint32 root = clusters.unite(a, b), other = root == a ? b : a;
+            tracker.merge(root, other, between);
+            members[root].insert(members[root].end(), members[other].begin(), members[other].end());
+            std::vector<quint32>().swap(members[other]);
         }
+        trace.push_back(tracker.modularity());
+    }
+}
 
-        quint64 m = 2*global_e;
-        double e = (double)intra/m;
-        double a = (double)(intra + inter)/m;
-        double Qi = e - qPow(a,2);
-        Q += Qi;
+/** Keep the first steps of the hierarchy and rebuild large_result from them
+ * @brief Graph::cut_hierarchy
+ * @param steps
+ */
+void Graph::cut_hierarchy(const quint32 &steps)
+{
+    while ((quint32) hierarchy.size() > steps)
+        hierarchy.removeLast();
+    quint32 n = myVertexList.size();
+    DisjointSet clusters(n);
+    for (int i = 0; i < hierarchy.size(); i++)
+        clusters.unite(hierarchy.at(i).first, hierarchy.at(i).second);
+    std::vector<quint32> label(n);
+    for (quint32 v = 0; v < n; v++)
+        label[v] = clusters.find(v);
+    parse_label_result(label);
+}
+
+/** Rebuild large_result from a cluster label per vertex, clusters in order of
+ * their first vertex; excluded vertices are left out
+ * @brief Graph::parse_label_result
+ * @param label below myVertexList.size()
+ */
+void Graph::parse_label_result(const std::vector<quint32> &label)
+{
+    std::vector<qint64> position(label.size(), -1);
+    large_result.clear();
+    for (quint32 v = 0; v < label.size(); v++)
+    {
+        if (large_excluded.contains(v))
+            continue;
+        quint32 c = label[v];
+        if (position[c] < 0)
+        {
+            position[c] = large_result.size();
+            large_result.append(QList<quint32>());
+        }
+        large_result[position[c]].append(v);
+    }
+}
+
+/** Cut the hierarchy where the modularity peaks (the earliest step if tied), so
+ * the result is the best level of the run without evaluating every level.
+ * The trace is written to modularity_trace.txt, one "step Q" per line
+ * @brief Graph::cut_hierarchy_at_best_modularity
+ * @return the modularity of the cut
+ */
+double Graph::cut_hierarchy_at_best_modularity()
+{
+    if (!graphIsReady)
+    {
+        clear_edge();
+        LARGE_reload_edges();
     }
+    global_e = myEdgeList.size();
+    std::vector<double> trace;
+    track_modularity(trace);
     graphIsReady = false;
-    return Q;
+    quint32 best = 0;
+    for (quint32 s = 1; s < trace.size(); s++)
+        if (trace[s] > trace[best])   best = s;
+    QFile file(globalDirPath + "/modularity_trace.txt");
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QTextStream out(&file);
+        out << "step\tQ\n";
+        for (quint32 s = 0; s < trace.size(); s++)
+            out << s << '\t' << trace[s] << '\n';
+        file.close();
+    }
+    qDebug() << "- Best Q:" << trace[best] << "At Step" << best << "Of" << hierarchy.size();
+    cut_hierarchy(best);
+    return trace[best];
 }
 
 double Graph::LARGE_compute_modularit_for_truth()
@@ -5364,104 +5407,55 @@ quint32 Graph::count_result_connected_component()
 
 
 
-/** Girvan and Newman Fraction of Correctly Classified
- * @brief Graph::compute_GN_index
- * @return
- */
-
-int countCommon(const QList<quint32> &A, const QList<quint32> &B)
-{
-    QSet<quint32> a = A.toSet(),
-                  b = B.toSet();
-    return a.intersect(b).size();
-}
-
-bool checkMerge(const QList<quint32> &A, const QList<QList<quint32> > &truth)
-{
-    QSet<quint32> cA = A.toSet();
-    int match = 0;
-    for(int i = 0 ; i < truth.size(); i++)
-    {
-        QList<quint32> c = truth.at(i);
-        int count = 0;
-        for(int j = 0; j < c.size(); j++)
-        {
-            if (cA.contains(c[j])) count++;
-        }
-        if (count == c.size()) match++;
-    }
-    if (match >= 2) return true;
-    else return false;
-}
-
 /**
  * @brief Graph::compute_GN_index
- * Fraction of Correctly Classified
+ * Girvan and Newman Fraction of Correctly Classified
  * Modified by adding a parameter:
+ * A vertex is correct if, apart from itself, at least half of its result cluster
+ * shares its ground truth community. A cluster of more than 2l vertices that
+ * contains two whole ground truth communities is a merge: none of its vertices is.
+ * This only depends on the truth histogram of each cluster, i.e. its column of
+ * the contingency table, so it is one pass over the cells, clusters in parallel
  * @param: l number of vertices per cluster
  * @return: [0,1]
  */
 double Graph::compute_GN_index(int l)
 {
-    quint32 n = myVertexList.size();
-    //indexing ground truth community
-    QMap<quint32,quint32> comm_map; //mapping vertex_id - comm_id
-    for (int i = 0; i < large_result.size(); i++)
+    if (large_result.empty())
     {
-        for(int j = 0; j < large_result.at(i).size(); j++)
-        {
-            quint32 vi = large_result.at(i).at(j);
-            comm_map.insert(vi,i);
-        }
-
+        qDebug() << "Newman Index - ERROR Large Result is Empty!";
+        return 0;
     }
-    //indexing result community
-    QList<int> v;
-    for (int i = 0; i < n; i++)
-        v.append(-1);
-
-    for (int i = 0; i < v.size(); i++)
-    {
-        if (v[i] == -1)
+    quint32 n = myVertexList.size();
+    ContingencyTable table;
+    build_contingency_table(table, l);
+    qint64 clusters = table.getNumberOfColumns();
+    quint64 match = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:match)
+    for (qint64 j = 0; j < clusters; j++)
+    {
+        quint64 size = table.columnSum(j);
+        //check for merging first
+        if (size > (quint64) l*2)
+        {
+            int whole = 0;
+            for (quint64 k = table.columnBegin(j); k < table.columnEnd(j); k++)
+                if (table.cellCount(k) == table.rowSum(table.cellRow(k)))
+                    whole++;
+            if (whole >= 2)
+                continue;
+        }
+        //compare matching
+        for (quint64 k = table.columnBegin(j); k < table.columnEnd(j); k++)
         {
-            quint32 truth_comm_index = i/l;
-            QList<quint32> truth = ground_truth_communities[truth_comm_index];
-            quint32 result_comm_index = comm_map.value(i);
-            QList<quint32> result = large_result[result_comm_index];
-            if (!result.contains(i) && !truth.contains(i))
-            {
-                qDebug() << "STRANGE";
-                return -1.0;
-            }
-            //check for merging first
-            if (result.size() > (l*2) && checkMerge(result, ground_truth_communities))
-            {
-                for(int i = 0; i < result.size(); i++)
-                    v[result[i]] = 0;
-            }
-            else
-            {
-            //compare matching
-                int common = countCommon(truth, result);
-                int correct = common - 1;
-                // if there are less than half of neighbours from the same community then it is placed in the wrong neighbourhood
-                if (correct < result.size() / 2)
-                {
-                    v[i] = 0;
-                }
-                else    v[i] = 1;
-            }
+            quint64 common = table.cellCount(k);
+            // if there are less than half of neighbours from the same community then it is placed in the wrong neighbourhood
+            if (common - 1 >= size / 2)
+                match += common;
         }
     }
-
-    int match = 0;
-    for (int i = 0; i < v.size(); i++)
-    {
-        if (v[i] < 0)
-            qDebug() << "Newman Index - ERROR Potential Duplication/Un-parsed result";
-        else
-            match += v[i];
-    }
+    if (table.total() < n)
+        qDebug() << "Newman Index - Vertices Without Cluster or Truth:" << n - table.total();
     double newman_index = (double)match/n;
     printf("Girvan Newman Fraction of Correctly Classified: %f", newman_index);
     return newman_index;
@@ -5472,40 +5466,11 @@ double Graph::compute_GN_index(int l)
  * The whole community is assigned a membership by majority
  * that is if a community is occupied by a number of a-c1, b-c2, c-c3 and d-c4
  * then the whole community is assigned by the max(a,b,c,d)
- * else if tie taken u.a.r
+ * Ties do not change the count. The memberships are the ground truth communities,
+ * or v/l when none is loaded
  * @param: l - number of veritces in a community
  * @return: the number of correct over sum vertices
  */
-// return the INDEX of the max membership
-inline int getMaxMembership(QList<int> membership)
-{
-    //check if equal
-    QList<int> largest; //index of largest membership
-    quint32 max = 0; //replace by INT_MAX maybe?
-    for (int i = 0; i < membership.size(); i++)
-    {
-        int count = membership.at(i);
-        if (count == max)
-        {
-            largest.append(i);
-        }
-        else if (count > max)
-        {
-            max = count;
-            largest.clear();
-            largest.append(i);
-        }
-    }
-    if (largest.size() == 1)    return largest[0];
-    else
-    {
-        std::uniform_int_distribution<int> dis(0,largest.size()-1);
-        int ran = dis(generator);
-        assert((ran <= largest.size()) && ("Out Of Bounds While Reaching For Max Element"));
-        return largest[ran];
-    }
-}
-
 double Graph::compute_majorities_membership(int l)
 {
     if (large_result.empty())
@@ -5514,24 +5479,17 @@ double Graph::compute_majorities_membership(int l)
         qDebug() << "Large Result is Empty! Maybe It has not been Reloaded?";
         return 0;
     }
-    int correct = 0;
-    for (size_t i = 0; i < large_result.size(); i++)
-    {
-        QList<quint32> community = large_result.at(i);
-        // first findout the majority membership
-        QList<int> membership;
-        membership << 0 << 0 << 0 << 0;
-        for (size_t i = 0; i < community.size(); i++)
-        {
-            quint32 v = community.at(i);
-            int v_membership = v/l;
-            if (v_membership == 0) membership[0]++;
-            else if (v_membership == 1) membership[1]++;
-            else if (v_membership == 2) membership[2]++;
-            else membership[3]++;
-        }
-        int index_of_majority = getMaxMembership(membership);
-        correct += membership[index_of_majority];
+    ContingencyTable table;
+    build_contingency_table(table, l);
+    qint64 clusters = table.getNumberOfColumns();
+    quint64 correct = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:correct)
+    for (qint64 j = 0; j < clusters; j++)
+    {
+        quint64 majority = 0;
+        for (quint64 k = table.columnBegin(j); k < table.columnEnd(j); k++)
+            majority = qMax(majority, table.cellCount(k));
+        correct += majority;
     }
     double frac = (double) correct/myVertexList.size();
     return frac;
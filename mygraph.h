@@ -6,6 +6,12 @@
 
 #include "vertex.h"
 #include "edge.h"
+#include "csrgraph.h"
+#include "contingencytable.h"
+#include "overlapscore.h"
+#include "clusterstats.h"
+#include "modularitytracker.h"
+#include "paircounttracker.h"
 
 #include "Snap.h"
 
@@ -16,6 +22,7 @@ public:
     ~Graph();
     //for working with snap
     PUNGraph convertToSnapUnGraph() const;
+    void read_snap_graph(const PUNGraph &G);
     bool convertCommToSnapVec(TVec < TCnCom > &CommV);
     bool convertSnapCommtoMyComm(const TVec < TCnCom > &CommV, QList<QList<quint32> > &result);
     //some simple Gnp generator
@@ -45,6 +52,8 @@ public:
     void get_bridge_stats();
     void LARGE_rerun();
     double LARGE_compute_modularity();
+    double LARGE_write_cluster_statistics();
+    double cut_hierarchy_at_best_modularity();
     double LARGE_compute_modularit_for_truth();
     quint32 count_result_connected_component();
     double compute_GN_index(int l);
@@ -57,18 +66,32 @@ public:
     bool LARGE_reload();
     //stats
     double cal_average_clustering_coefficient();
+    double cal_average_clustering_coefficient(const quint32 &sampleNodes);
+    std::vector<double> cal_local_clustering_coefficients();
+    double cal_global_clustering_coefficient();
+    void benchmark_degree_biased_neighbour_sampling(const quint32 &draws);
     void clear_log();
     //Random Mapping
     void random_functional_digraph();
     //Girvan and Newman Betweenness Centrality
     void betweenness_centrality_clustering();
     void fast_CMN();
+    //Louvain, or Leiden with refine
+    void parallel_louvain(const bool &refine);
+    //label propagation
+    void parallel_label_propagation();
     //aggregation
+    void set_folding(const bool &enabled);
+    void set_core_peeling(const bool &enabled);
+    void set_modularity_cut(const bool &enabled);
     void random_aggregate();
     void reverse_random_aggregate();
     void random_aggregate_with_degree_comparison();
     void reverse_random_aggregate_with_degree_comparison();
     void random_aggregate_with_weight_comparison();
+    void parallel_random_aggregate();
+    void parallel_random_aggregate_with_degree_comparison();
+    void parallel_random_aggregate_with_weight_comparison();
     void random_aggregate_with_neighbour_initial_degree_bias();
     void random_aggregate_with_neighbour_initial_degree_bias_with_constraint();
     void random_aggregate_with_neighbour_CURRENT_degree_bias();
@@ -84,8 +107,8 @@ public:
     void random_aggregate_greedy_max_weight();
     //agg without 'removing' vertices
     void IIIaFindRoot(QList<quint32> &roots, int degreeType);
-    void reconstructGraphRecursiveIIIa(QList<quint32> &roots);
-    void recursive_IIIa();
+    void reconstructGraphRecursiveIIIa(const QList<quint32> &roots);
+    void recursive_IIIa(const bool &saveSnapshots = false);
     void IIIa_triangulation_k_max_neighbours(const int &k);
     void IIIa_triangulation_j_from_k_max_neighbours(const int &j, const int &k);
     void random_aggregate_retain_vertex_using_triangulation();
@@ -110,6 +133,9 @@ public:
     void colouring_cluster_result();
     //quality
     QList<double> LARGE_compute_Pairwise_efficient(int n);
+    QList<double> LARGE_compute_information_measures();
+    QList<double> LARGE_compute_overlapping_measures();
+    QList<double> LARGE_compute_Pairwise_trace(const quint32 &every);
     double LARGE_compute_Newman_fraction_of_classified();
     bool locate_file_in_dir(QString &fileName);
 private:
@@ -121,6 +147,19 @@ private:
     bool checkGraphCondition();
     void reConnectGraph();
     void clear_edge();
+    void track_neighbour_keys(const int &key);
+    void build_csr(CSRGraph &csr);
+    void parallel_handshake_aggregate(const int &type);
+    quint32 fold_pendants_and_chains();
+    template <class A>
+    void run_aggregator(const int &type, const char *name);
+    void count_triangles();
+    bool triangles_are_current() const;
+    const std::vector<quint32> & count_vertex_triangles();
+    const std::vector<quint32> & count_edge_support();
+    const std::vector<quint32> & count_core_numbers();
+    void forget_core_numbers();
+    void batch_k_most_mutual_neighbours(const int &k, std::vector<QList<Edge*> > &topk);
     // for large graph
     void reindexing();
     void reindexing_ground_truth();
@@ -156,6 +195,11 @@ private:
     void get_one_level_cluster(QString filename, QList<QList<quint32> > &clus);
 
     quint32 count_unique_element();
+    void build_contingency_table(ContingencyTable &table, const int &l = 0);
+    void count_cluster_statistics(ClusterStats &stats);
+    void track_modularity(std::vector<double> &trace);
+    void cut_hierarchy(const quint32 &steps);
+    void parse_label_result(const std::vector<quint32> &label);
     quint64 calA(QList<quint64> param);
     quint64 calB(QList<quint64> param);
     quint64 calC(QList<quint64> param);
@@ -170,11 +214,27 @@ private:
     QList<Vertex*> centroids;
     //
     QList<QList<quint32> > ground_truth_communities;
+    //as read, before large_process_overlap*()
+    QList<QList<quint32> > overlapping_ground_truth;
     QList<QPair<quint32,quint32> > hierarchy;
     QList<QList<quint32> > large_result;
     QSet<quint32> large_excluded;
     QMap<quint32, quint32> overlapped_vertices_ground_truth_cluster;
+    //triangle cache, see count_vertex_triangles()
+    CSRGraph myTriangleCSR;
+    std::vector<quint32> myEdgeSupport;
+    std::vector<quint32> myVertexTriangles;
+    quint64 myTriangleStamp;
+    quint64 myTriangleRemovalStamp;
+    bool trianglesAreCounted;
+    //core cache, see count_core_numbers()
+    std::vector<quint32> myCoreNumbers;
+    quint64 myCoreStamp;
+    bool coresAreCounted;
     //
     bool graphIsReady;
+    bool foldingEnabled;
+    bool corePeelingEnabled;
+    bool modularityCutEnabled;
 };
 #endif // GRAPH_H
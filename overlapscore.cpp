@@ -0,0 +1,179 @@
+#include "overlapscore.h"
+
+#include <cmath>
+
+#include <QDebug>
+
+namespace
+{
+    // h(w, n) = -w log2(w / n), 0 for w = 0
+    inline double h(const double &w, const double &n)
+    {
+        return w <= 0.0 ? 0.0 : -w * std::log(w / n) / std::log(2.0);
+    }
+}
+
+OverlapScore::OverlapScore()
+{
+}
+
+/**
+ * @brief OverlapScore::build
+ * @param truth ground truth communities (may overlap)
+ * @param result result clusters (may overlap)
+ * @param n number of vertices being compared
+ */
+void OverlapScore::build(const QList<QList<quint32> > &truth, const QList<QList<quint32> > &result, const quint64 &n)
+{
+    quint32 bound = 0;
+    for (int i = 0; i < truth.size(); i++)
+        for (int k = 0; k < truth.at(i).size(); k++)
+            bound = qMax(bound, truth.at(i).at(k) + 1);
+    for (int j = 0; j < result.size(); j++)
+        for (int k = 0; k < result.at(j).size(); k++)
+            bound = qMax(bound, result.at(j).at(k) + 1);
+    if (n < bound)
+        qDebug() << "OVERLAP SCORE: n IS SMALLER THAN THE VERTEX INDICES!";
+    Index truthIndex, resultIndex;
+    index(truth, bound, truthIndex);
+    index(result, bound, resultIndex);
+    match(truth, resultIndex, n, myTruthF1, myTruthCondH, myTruthH);
+    match(result, truthIndex, n, myResultF1, myResultCondH, myResultH);
+}
+
+/** CSR of the memberships: communities of v in [offset[v], offset[v+1])
+ * @brief OverlapScore::index
+ * @param C
+ * @param bound vertex indices are in [0, bound)
+ * @param idx
+ */
+void OverlapScore::index(const QList<QList<quint32> > &C, const quint32 &bound, Index &idx)
+{
+    idx.offset.assign((quint64) bound + 1, 0);
+    idx.size.resize(C.size());
+    for (int c = 0; c < C.size(); c++)
+    {
+        idx.size[c] = C.at(c).size();
+        foreach (quint32 v, C.at(c))
+            idx.offset[v+1]++;
+    }
+    for (quint32 v = 0; v < bound; v++)
+        idx.offset[v+1] += idx.offset[v];
+    idx.community.resize(idx.offset[bound]);
+    std::vector<quint64> fill(idx.offset.begin(), idx.offset.end() - 1);
+    for (int c = 0; c < C.size(); c++)
+        foreach (quint32 v, C.at(c))
+            idx.community[fill[v]++] = c;
+}
+
+/** For every community X of from: the best F1 against the communities of the
+ * other side, the smallest admissible H(X|Y) (LFK constraint, H(X) when none is)
+ * and the entropy H(X). Communities in parallel, each thread with its own counters
+ * @brief OverlapScore::match
+ * @param from
+ * @param to inverted index of the other side
+ * @param n
+ * @param bestF1
+ * @param bestH
+ * @param H
+ */
+void OverlapScore::match(const QList<QList<quint32> > &from, const Index &to, const quint64 &n,
+                         std::vector<double> &bestF1, std::vector<double> &bestH, std::vector<double> &H)
+{
+    qint64 size = from.size();
+    bestF1.assign(size, 0.0);
+    bestH.assign(size, 0.0);
+    H.assign(size, 0.0);
+    double N = n;
+    #pragma omp parallel
+    {
+        std::vector<quint32> common(to.size.size(), 0);
+        std::vector<quint32> touched;
+        #pragma omp for schedule(dynamic, 16)
+        for (qint64 i = 0; i < size; i++)
+        {
+            const QList<quint32> &X = from.at(i);
+            touched.clear();
+            foreach (quint32 v, X)
+            {
+                for (quint64 s = to.offset[v]; s < to.offset[v+1]; s++)
+                {
+                    quint32 c = to.community[s];
+                    if (common[c]++ == 0)
+                        touched.push_back(c);
+                }
+            }
+            double x = X.size();
+            double hx = h(x, N) + h(N - x, N);
+            double f1 = 0.0, condH = hx;
+            for (size_t t = 0; t < touched.size(); t++)
+            {
+                quint32 c = touched[t];
+                double d = common[c], y = to.size[c];
+                common[c] = 0;
+                f1 = qMax(f1, 2.0 * d / (x + y));
+                double a = N - x - y + d, b = y - d, e = x - d;
+                if (h(a, N) + h(d, N) < h(b, N) + h(e, N))
+                    continue;
+                double cond = h(a, N) + h(b, N) + h(e, N) + h(d, N) - h(b + d, N) - h(a + e, N);
+                condH = qMin(condH, cond);
+            }
+            bestF1[i] = f1;
+            bestH[i] = condH;
+            H[i] = hx;
+        }
+    }
+}
+
+/** 1/2 (mean over truth of the best F1 + mean over result of the best F1)
+ * @brief OverlapScore::averageF1
+ * @return
+ */
+double OverlapScore::averageF1() const
+{
+    double truth = 0.0, result = 0.0;
+    for (size_t i = 0; i < myTruthF1.size(); i++)    truth += myTruthF1[i];
+    for (size_t j = 0; j < myResultF1.size(); j++)   result += myResultF1[j];
+    if (!myTruthF1.empty())     truth /= myTruthF1.size();
+    if (!myResultF1.empty())    result /= myResultF1.size();
+    return (truth + result) / 2.0;
+}
+
+/** 1 - 1/2 (H(X|Y)_norm + H(Y|X)_norm), H(X|Y)_norm the mean of H(X_i|Y) / H(X_i)
+ * @brief OverlapScore::onmiLFK
+ * @return
+ */
+double OverlapScore::onmiLFK() const
+{
+    double truth = 0.0, result = 0.0;
+    for (size_t i = 0; i < myTruthH.size(); i++)
+        truth += myTruthH[i] > 0.0 ? myTruthCondH[i] / myTruthH[i] : 0.0;
+    for (size_t j = 0; j < myResultH.size(); j++)
+        result += myResultH[j] > 0.0 ? myResultCondH[j] / myResultH[j] : 0.0;
+    if (!myTruthH.empty())      truth /= myTruthH.size();
+    if (!myResultH.empty())     result /= myResultH.size();
+    return 1.0 - (truth + result) / 2.0;
+}
+
+/** 1/2 (H(X) - H(X|Y) + H(Y) - H(Y|X)) / max(H(X), H(Y)), sums over the communities
+ * @brief OverlapScore::onmiMax
+ * @return
+ */
+double OverlapScore::onmiMax() const
+{
+    double hx = 0.0, hxy = 0.0, hy = 0.0, hyx = 0.0;
+    for (size_t i = 0; i < myTruthH.size(); i++)
+    {
+        hx += myTruthH[i];
+        hxy += myTruthCondH[i];
+    }
+    for (size_t j = 0; j < myResultH.size(); j++)
+    {
+        hy += myResultH[j];
+        hyx += myResultCondH[j];
+    }
+    double m = qMax(hx, hy);
+    if (m == 0.0)
+        return 1.0;
+    return (hx - hxy + hy - hyx) / 2.0 / m;
+}
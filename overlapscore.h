@@ -0,0 +1,44 @@
+#ifndef OVERLAPSCORE_H
+#define OVERLAPSCORE_H
+
+#include <QList>
+#include <vector>
+
+/** Comparison of two covers (communities may overlap) of the same vertices:
+ * average best-match F1 and overlapping NMI, both the LFK version
+ * (Lancichinetti, Fortunato, Kertesz) and the max normalised one (McDaid et al.).
+ * Each side gets an inverted vertex -> communities index, so a community is only
+ * compared with the communities of the other side it intersects:
+ * O(sum over vertices of memberships(v) x memberships'(v)) instead of all pairs.
+ * A pair that shares no vertex has F1 = 0 and, for communities smaller than n/e,
+ * fails the LFK constraint, so skipping it leaves both scores unchanged.
+ */
+class OverlapScore
+{
+public:
+    OverlapScore();
+
+    void build(const QList<QList<quint32> > &truth, const QList<QList<quint32> > &result, const quint64 &n);
+
+    double averageF1() const;
+    double onmiLFK() const;
+    double onmiMax() const;
+
+private:
+    struct Index
+    {
+        std::vector<quint64> offset;
+        std::vector<quint32> community;
+        std::vector<quint64> size;
+    };
+
+    static void index(const QList<QList<quint32> > &C, const quint32 &bound, Index &idx);
+    static void match(const QList<QList<quint32> > &from, const Index &to, const quint64 &n,
+                      std::vector<double> &bestF1, std::vector<double> &bestH, std::vector<double> &H);
+
+    std::vector<double> myTruthF1, myResultF1;
+    std::vector<double> myTruthCondH, myResultCondH;
+    std::vector<double> myTruthH, myResultH;
+};
+
+#endif // OVERLAPSCORE_H
@@ -0,0 +1,120 @@
+#include "paircounttracker.h"
+
+const quint32 PairCountTracker::NO_LABEL;
+
+PairCountTracker::PairCountTracker()
+{
+    myLabelled = 0;
+    myTogether = 0;
+    myTruthPairs = 0;
+    myClusterPairs = 0;
+}
+
+/** Every vertex a singleton cluster
+ * @brief PairCountTracker::reset
+ * @param truthOf ground truth community of every vertex, NO_LABEL if it is not compared
+ */
+void PairCountTracker::reset(const std::vector<quint32> &truthOf)
+{
+    myTruthOf = truthOf;
+    myCount.assign(truthOf.size(), 0);
+    myHistogram.clear();
+    myHistogram.resize(truthOf.size());
+    myLabelled = 0;
+    myTogether = 0;
+    myTruthPairs = 0;
+    myClusterPairs = 0;
+    QHash<quint32, quint64> truthSize;
+    for (size_t v = 0; v < truthOf.size(); v++)
+    {
+        if (truthOf[v] == NO_LABEL)
+            continue;
+        myCount[v] = 1;
+        myLabelled++;
+        truthSize[truthOf[v]]++;
+    }
+    for (QHash<quint32, quint64>::const_iterator it = truthSize.constBegin(); it != truthSize.constEnd(); ++it)
+        myTruthPairs += it.value()*(it.value() - 1)/2;
+}
+
+/** A cluster with a single labelled vertex is that vertex alone (plus unlabelled
+ * ones merged into it), its histogram is only written out when it grows
+ * @brief PairCountTracker::materialise
+ * @param c
+ */
+void PairCountTracker::materialise(const quint32 &c)
+{
+    if (myCount[c] == 1 && myHistogram[c].empty())
+        myHistogram[c].insert(myTruthOf[c], 1);
+}
+
+/**
+ * @brief PairCountTracker::merge
+ * @param into root of the cluster that remains
+ * @param from root of the cluster merged into it
+ */
+void PairCountTracker::merge(const quint32 &into, const quint32 &from)
+{
+    materialise(into);
+    materialise(from);
+    if (myHistogram[into].size() < myHistogram[from].size())
+        myHistogram[into].swap(myHistogram[from]);
+    QHash<quint32, quint32> &larger = myHistogram[into];
+    const QHash<quint32, quint32> &smaller = myHistogram[from];
+    for (QHash<quint32, quint32>::const_iterator it = smaller.constBegin(); it != smaller.constEnd(); ++it)
+    {
+        quint32 &cell = larger[it.key()];
+        myTogether += (quint64) cell*it.value();
+        cell += it.value();
+    }
+    myClusterPairs += (quint64) myCount[into]*myCount[from];
+    myCount[into] += myCount[from];
+    myCount[from] = 0;
+    QHash<quint32, quint32>().swap(myHistogram[from]);
+}
+
+quint64 PairCountTracker::getNumberOfLabelled() const
+{
+    return myLabelled;
+}
+
+/** (a + d) / C(n,2), pairs on which both agree
+ * @brief PairCountTracker::rand
+ * @return
+ */
+double PairCountTracker::rand() const
+{
+    quint64 pairs = myLabelled*(myLabelled - 1)/2;
+    if (pairs == 0)
+        return 1.0;
+    quint64 disagree = myTruthPairs + myClusterPairs - 2*myTogether;
+    return (double) (pairs - disagree)/pairs;
+}
+
+/** a / (a + b + c)
+ * @brief PairCountTracker::jaccard
+ * @return
+ */
+double PairCountTracker::jaccard() const
+{
+    quint64 together = myTruthPairs + myClusterPairs - myTogether;
+    if (together == 0)
+        return 0.0;
+    return (double) myTogether/together;
+}
+
+/** As Graph::calAdRand
+ * @brief PairCountTracker::adjustedRand
+ * @return
+ */
+double PairCountTracker::adjustedRand() const
+{
+    quint64 pairs = myLabelled*(myLabelled - 1)/2;
+    if (pairs == 0)
+        return 0.0;
+    double nc = (double) myTruthPairs*myClusterPairs/pairs;
+    double denom = (double) (myTruthPairs + myClusterPairs)/2 - nc;
+    if (denom == 0.0)
+        return 0.0;
+    return (myTogether - nc)/denom;
+}
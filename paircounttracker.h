@@ -0,0 +1,43 @@
+#ifndef PAIRCOUNTTRACKER_H
+#define PAIRCOUNTTRACKER_H
+
+#include <QHash>
+#include <vector>
+
+/** Pair counting indices (RAND, Jaccard, ARI) of a clustering against the ground
+ * truth under a sequence of merges, starting from singletons.
+ * Merging clusters A and B only changes the cells of the truth communities both
+ * touch: sum C(n_ij,2) grows by n_iA n_iB for each of them and sum C(b_j,2) by
+ * b_A b_B, while sum C(a_i,2) is fixed. Every cluster keeps its truth histogram
+ * and the smaller histogram is folded into the larger, so a merge costs the size
+ * of the smaller one and a whole merge sequence O(n log n)
+ */
+class PairCountTracker
+{
+public:
+    static const quint32 NO_LABEL = 0xFFFFFFFF;
+
+    PairCountTracker();
+
+    void reset(const std::vector<quint32> &truthOf);
+    void merge(const quint32 &into, const quint32 &from);
+
+    quint64 getNumberOfLabelled() const;
+    double rand() const;
+    double jaccard() const;
+    double adjustedRand() const;
+
+private:
+    void materialise(const quint32 &c);
+
+    std::vector<quint32> myTruthOf;
+    std::vector<quint32> myCount;
+    //empty for a cluster with at most one labelled vertex, its root, see materialise()
+    std::vector<QHash<quint32, quint32> > myHistogram;
+    quint64 myLabelled;
+    quint64 myTogether;     // sum C(n_ij,2)
+    quint64 myTruthPairs;   // sum C(a_i,2)
+    quint64 myClusterPairs; // sum C(b_j,2)
+};
+
+#endif // PAIRCOUNTTRACKER_H
@@ -0,0 +1,193 @@
+#include "rng.h"
+
+#include <chrono>
+
+#include <QDebug>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const quint32 PHILOX_M0 = 0xD2511F53;
+static const quint32 PHILOX_M1 = 0xCD9E8D57;
+static const quint32 PHILOX_W0 = 0x9E3779B9;
+static const quint32 PHILOX_W1 = 0xBB67AE85;
+
+const quint32 Rng::GRAPH_KEY;
+const quint32 Rng::HANDSHAKE_LANE;
+const quint32 Rng::LEIDEN_LANE;
+const quint32 Rng::LABEL_PROPAGATION_LANE;
+const int RngBuffer::BLOCK_WORDS;
+
+static quint64 runSeed = 0;
+static bool runSeedIsSet = false;
+static quint32 runEpoch = 0;
+static RngBuffer globalStream;
+
+RngStream::RngStream()
+{
+    mySeed = 0;
+    myStreamId = 0;
+    myCounter = 0;
+    myCached = 0;
+}
+
+RngStream::RngStream(const quint64 &seed, const quint64 &streamId, const quint64 &counter)
+{
+    mySeed = seed;
+    myStreamId = streamId;
+    myCached = 0;
+    setCounter(counter);
+}
+
+/** Jump to an absolute position of the stream
+ * @brief RngStream::setCounter
+ * @param counter
+ */
+void RngStream::setCounter(const quint64 &counter)
+{
+    myCounter = counter;
+    if (myCounter & 1)
+    {
+        quint64 lo;
+        block(myCounter >> 1, lo, myCached);
+    }
+}
+
+quint64 RngStream::getCounter() const
+{
+    return myCounter;
+}
+
+quint64 RngStream::getStreamId() const
+{
+    return myStreamId;
+}
+
+/** Philox4x32-10: the 128 bit counter is (block index, stream id), the key is the run seed
+ * @brief RngStream::block
+ * @param blockIndex
+ * @param lo
+ * @param hi
+ */
+void RngStream::block(const quint64 &blockIndex, quint64 &lo, quint64 &hi) const
+{
+    quint32 c0 = (quint32) blockIndex, c1 = (quint32) (blockIndex >> 32);
+    quint32 c2 = (quint32) myStreamId, c3 = (quint32) (myStreamId >> 32);
+    quint32 k0 = (quint32) mySeed, k1 = (quint32) (mySeed >> 32);
+    for (int r = 0; r < 10; r++)
+    {
+        quint64 p0 = (quint64) PHILOX_M0 * c0;
+        quint64 p1 = (quint64) PHILOX_M1 * c2;
+        quint32 n0 = (quint32) (p1 >> 32) ^ c1 ^ k0;
+        quint32 n2 = (quint32) (p0 >> 32) ^ c3 ^ k1;
+        c1 = (quint32) p1;
+        c3 = (quint32) p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    lo = ((quint64) c1 << 32) | c0;
+    hi = ((quint64) c3 << 32) | c2;
+}
+
+RngBuffer::RngBuffer()
+{
+    myPos = BLOCK_WORDS;
+}
+
+RngBuffer::RngBuffer(const RngStream &stream)
+{
+    myStream = stream;
+    myPos = BLOCK_WORDS;
+}
+
+/** Draw a whole block in one tight loop
+ * @brief RngBuffer::refill
+ */
+void RngBuffer::refill()
+{
+    for (int i = 0; i < BLOCK_WORDS; i += 2)
+    {
+        quint64 r = myStream();
+        myWords[i] = (quint32) (r >> 32);
+        myWords[i+1] = (quint32) r;
+    }
+    myPos = 0;
+}
+
+/** Fix the seed of the whole process so any run can be replayed
+ * @brief Rng::setRunSeed
+ * @param seed
+ */
+void Rng::setRunSeed(const quint64 &seed)
+{
+    runSeed = seed;
+    runSeedIsSet = true;
+    runEpoch = 0;
+    globalStream = RngBuffer(stream(GRAPH_KEY));
+    qDebug() << "- RNG Run Seed Set To" << runSeed;
+}
+
+/** Seed defaults to the clock on first use and is logged so it can be passed back to setRunSeed
+ * @brief Rng::getRunSeed
+ * @return
+ */
+quint64 Rng::getRunSeed()
+{
+    if (!runSeedIsSet)
+    {
+        quint64 seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        setRunSeed(seed);
+    }
+    return runSeed;
+}
+
+/** Start a new epoch: every stream handed out afterwards is disjoint from earlier runs
+ * @brief Rng::beginRun
+ */
+void Rng::beginRun()
+{
+    getRunSeed();
+    runEpoch++;
+    globalStream = RngBuffer(stream(GRAPH_KEY));
+}
+
+quint32 Rng::getRunEpoch()
+{
+    return runEpoch;
+}
+
+/** Stream id layout: key (32 bit) | thread (8 bit) | run epoch (24 bit)
+ * @brief Rng::stream
+ * @param key vertex index or GRAPH_KEY for graph level draws
+ * @param thread worker index
+ * @return
+ */
+RngStream Rng::stream(const quint32 &key, const quint32 &thread)
+{
+    quint64 id = ((quint64) (runEpoch & 0xFFFFFF) << 40)
+            | ((quint64) (thread & 0xFF) << 32)
+            | key;
+    return RngStream(getRunSeed(), id);
+}
+
+/** Stream used by the sequential parts of Graph, re-keyed by beginRun
+ * @brief Rng::global
+ * @return
+ */
+RngBuffer & Rng::global()
+{
+    getRunSeed();
+    return globalStream;
+}
+
+quint32 Rng::threadIndex()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,180 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <QtGlobal>
+#include <limits>
+
+/** Lemire's multiply-shift: uniform integer in [0, range) without a division
+ * except on the rare rejection path. range must be positive.
+ */
+template <typename G>
+inline quint32 rngBounded(G &g, const quint32 &range)
+{
+    quint64 m = (quint64) g.next32() * range;
+    quint32 low = (quint32) m;
+    if (low < range)
+    {
+        quint32 threshold = (0u - range) % range;
+        while (low < threshold)
+        {
+            m = (quint64) g.next32() * range;
+            low = (quint32) m;
+        }
+    }
+    return (quint32) (m >> 32);
+}
+
+/** Uniform integer in [0, range) for 64 bit ranges: Lemire below 2^32,
+ * masked rejection above (accepts with probability > 1/2)
+ */
+template <typename G>
+inline quint64 rngBounded64(G &g, const quint64 &range)
+{
+    if (range <= 0xFFFFFFFFull)
+        return rngBounded(g, (quint32) range);
+    quint64 mask = range - 1;
+    mask |= mask >> 1; mask |= mask >> 2; mask |= mask >> 4;
+    mask |= mask >> 8; mask |= mask >> 16; mask |= mask >> 32;
+    quint64 x;
+    do
+    {
+        x = g() & mask;
+    } while (x >= range);
+    return x;
+}
+
+/** Counter-based random stream (Philox4x32-10).
+ * A stream is the pure function (run seed, stream id, counter) -> 64 bit,
+ * so two streams with different ids never share a block and any draw can
+ * be reproduced from its coordinates alone, whatever the thread schedule.
+ * Satisfies UniformRandomBitGenerator, so std distributions accept it.
+ */
+class RngStream
+{
+public:
+    typedef quint64 result_type;
+
+    RngStream();
+    RngStream(const quint64 &seed, const quint64 &streamId, const quint64 &counter = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<quint64>::max(); }
+
+    inline result_type operator()()
+    {
+        // each Philox block yields two 64 bit draws; odd counters use the cached half
+        if (myCounter & 1)
+        {
+            myCounter++;
+            return myCached;
+        }
+        quint64 lo;
+        block(myCounter >> 1, lo, myCached);
+        myCounter++;
+        return lo;
+    }
+
+    inline quint32 next32()
+    {
+        return (quint32) (operator()() >> 32);
+    }
+
+    inline quint32 bounded(const quint32 &range)
+    {
+        return rngBounded(*this, range);
+    }
+
+    inline quint64 bounded64(const quint64 &range)
+    {
+        return rngBounded64(*this, range);
+    }
+
+    void setCounter(const quint64 &counter);
+    quint64 getCounter() const;
+    quint64 getStreamId() const;
+
+private:
+    void block(const quint64 &blockIndex, quint64 &lo, quint64 &hi) const;
+
+    quint64 mySeed;
+    quint64 myStreamId;
+    quint64 myCounter;
+    quint64 myCached;
+};
+
+/** Batched front end of a stream: refills a block of 32 bit words at once
+ * so the hot loops only pay an array read per draw.
+ */
+class RngBuffer
+{
+public:
+    typedef quint64 result_type;
+    static const int BLOCK_WORDS = 512;
+
+    RngBuffer();
+    RngBuffer(const RngStream &stream);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<quint64>::max(); }
+
+    inline quint32 next32()
+    {
+        if (myPos == BLOCK_WORDS)
+            refill();
+        return myWords[myPos++];
+    }
+
+    inline result_type operator()()
+    {
+        quint64 hi = next32();
+        return (hi << 32) | next32();
+    }
+
+    inline quint32 bounded(const quint32 &range)
+    {
+        return rngBounded(*this, range);
+    }
+
+    inline quint64 bounded64(const quint64 &range)
+    {
+        return rngBounded64(*this, range);
+    }
+
+private:
+    void refill();
+
+    RngStream myStream;
+    quint32 myWords[BLOCK_WORDS];
+    int myPos;
+};
+
+/** Process-wide seed service.
+ * Stream ids pack (run epoch, thread, key): key is usually a vertex index,
+ * thread the worker index, and the epoch advances once per Graph so repeated
+ * runs in one process stay independent while still being reproducible
+ * from the single run seed that is logged when it is first drawn.
+ * Engines that draw per vertex besides Vertex::myRng (thread 0) take their
+ * own lane in the thread field, so their words never replay the vertex ones.
+ */
+class Rng
+{
+public:
+    static const quint32 GRAPH_KEY = 0xFFFFFFFF;
+    //thread field lanes, above any worker index
+    static const quint32 HANDSHAKE_LANE = 0xF0;
+    static const quint32 LEIDEN_LANE = 0xF1;
+    static const quint32 LABEL_PROPAGATION_LANE = 0xF2;
+
+    static void setRunSeed(const quint64 &seed);
+    static quint64 getRunSeed();
+
+    static void beginRun();
+    static quint32 getRunEpoch();
+
+    static RngStream stream(const quint32 &key, const quint32 &thread = 0);
+    static RngBuffer & global();
+
+    static quint32 threadIndex();
+};
+
+#endif // RNG_H
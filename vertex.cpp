@@ -2,13 +2,18 @@
 #include "edge.h"
 
 #include <random>
+#include <algorithm>
+#include <functional>
 
-#include <QTime>
 #include <QDebug>
-#include <QTime>
 
-std::default_random_engine gen;
+// bumped on every edge insertion: neighbour degree bounds computed before are stale
+quint64 Vertex::edgeAdditions = 0;
+// bumped on every edge removal: exact counts (triangles) computed before are stale
+quint64 Vertex::edgeRemovals = 0;
 
+//a rejection draw is kept when its expected trials are at most d / REJECTION_GAIN
+static const quint64 REJECTION_GAIN = 4;
 
 Vertex::Vertex()
 {
@@ -20,12 +25,19 @@ Vertex::Vertex()
     ExtraWeight = 0;
     cSize = 0;
     myRealCommunity = -1;
-    gen.seed(QTime::currentTime().msec());
-
+    myNeighbourKey = NO_KEY;
+    myNotifySuspended = false;
+    myNeighbourQueue = 0;
+    myNeighbourDegreeBound = 0;
+    myBoundVersion = 0;
+    myCore = UNKNOWN_CORE;
+    resetChain(ABSORBED_CHAIN);
+    resetChain(CLUSTER_CHAIN);
 }
 
 Vertex::~Vertex()
 {
+    untrackNeighbours();
     foreach (Edge *edge, myEdge)
         delete edge;
 }
@@ -33,6 +45,7 @@ Vertex::~Vertex()
 void Vertex::setIndex(const quint32 &number)
 {
     myIndex = number;
+    myRng = Rng::stream(myIndex);
 }
 
 quint32 Vertex::getIndex() const
@@ -82,14 +95,16 @@ void Vertex::removeAll()
 void Vertex::setWeight(const quint64 &w)
 {
     myWeight = w;
+    if (myNeighbourKey == WEIGHT_KEY)
+        notifyNeighbours();
 }
 
 void Vertex::setWeightAsNumberOfAbsorbed()
 {
-    if (absorbed.size() == 0)
+    if (myChain[ABSORBED_CHAIN].count == 0)
         return;
     else
-        myWeight = absorbed.size();
+        myWeight = myChain[ABSORBED_CHAIN].count;
 }
 
 quint64 Vertex::getWeight() const
@@ -112,10 +127,8 @@ void Vertex::setParent(Vertex *v)
         v->incrementNoChild();
         v->setExtraWeight(this->getWeight());
 
-        //readjustcluter
-        v->addMemberToCluster(this);
-        v->addMemberToCluster(myCluster);
-        myCluster.clear();
+        //readjustcluter: this and its members move to v
+        v->spliceChain(CLUSTER_CHAIN, this);
     }
 }
 
@@ -180,7 +193,7 @@ void Vertex::setNoOfChild(const quint32 &nochild)
 
 QList<Vertex *> Vertex::getAbsorbedList()
 {
-    return absorbed;
+    return chainMembers(ABSORBED_CHAIN);
 }
 
 QList<quint32> Vertex::getNeighbourIndexes()
@@ -201,7 +214,10 @@ void Vertex::addEdge(Edge *edge)
         //DUP
     }
     else
+    {
         myEdge.append(edge);
+        edgeAdditions++;
+    }
 }
 
 void Vertex::removeEdge(Edge *edge)
@@ -211,8 +227,13 @@ void Vertex::removeEdge(Edge *edge)
         if (edge != 0)
         {
             myEdge.removeOne(edge);
+            edgeRemovals++;
             Vertex * neighbour = this->get_neighbour_fromEdge(edge);
             myNeighbours.removeOne(neighbour->getIndex());
+            if (myNeighbourQueue != 0)
+                myNeighbourQueue->remove(edge->getSlot(this));
+            if (myNeighbourKey == DEGREE_KEY)
+                notifyNeighbours();
         }
     }
 }
@@ -224,8 +245,11 @@ quint32 Vertex::getNumberEdge() const
 
 void Vertex::remove_all_edges()
 {
+    //nobody keeps the key of a vertex with no edge left, skip the d^2 notifications
+    myNotifySuspended = true;
     foreach (Edge *edge, myEdge)
         edge->removeAll();
+    myNotifySuspended = false;
 }
 
 Edge *Vertex::getEdgeFromVertex(Vertex * v2)
@@ -243,6 +267,8 @@ Edge *Vertex::getEdgeFromVertex(Vertex * v2)
 
 Edge *Vertex::getSmallestCurrentDegreeNeighbour()
 {
+    if (myNeighbourKey == DEGREE_KEY && myNeighbourQueue != 0 && !myNeighbourQueue->empty())
+        return myTrackedEdge.at(myNeighbourQueue->randomMin(myRng));
     QList<quint32> indexes;
     quint32 smallest = 999999;
     for (int i = 0; i < myEdge.size(); i++)
@@ -266,14 +292,15 @@ Edge *Vertex::getSmallestCurrentDegreeNeighbour()
         return myEdge[indexes[0]];
     else
     {
-        std::uniform_int_distribution<int> distribution(0,indexes.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(indexes.size());
         return myEdge.at(indexes[ran]);
     }
 }
 
 Edge *Vertex::getSmallestCurrentWeightNeighbour()
 {
+    if (myNeighbourKey == WEIGHT_KEY && myNeighbourQueue != 0 && !myNeighbourQueue->empty())
+        return myTrackedEdge.at(myNeighbourQueue->randomMin(myRng));
     QList<quint32> indexes;
     quint64 smallest = 99999999;
     for (int i = 0; i < myEdge.size(); i++)
@@ -297,8 +324,7 @@ Edge *Vertex::getSmallestCurrentWeightNeighbour()
         return myEdge[indexes[0]];
     else
     {
-        std::uniform_int_distribution<int> distribution(0,indexes.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(indexes.size());
         return myEdge.at(indexes[ran]);
     }
 }
@@ -313,8 +339,7 @@ void Vertex::absorb_removeEdge(quint32 edge_index)
     else
         neighbour = edge->fromVertex();
     neighbour->remove_all_edges();
-    absorbed.append(neighbour);
-    absorbed.append(neighbour->getAbsorbedList());
+    spliceChain(ABSORBED_CHAIN, neighbour);
     neighbour->setParent(this);
 }
 
@@ -332,8 +357,7 @@ void Vertex::absorb_removeEdge(Edge *e)
         neighbour = e->fromVertex();
    // neighbour->loser_drag_vertex_with_degree_one(e);
     neighbour->remove_all_edges();
-    absorbed.append(neighbour);
-    absorbed.append(neighbour->getAbsorbedList());
+    spliceChain(ABSORBED_CHAIN, neighbour);
     neighbour->setParent(this);
 }
 
@@ -349,15 +373,14 @@ void Vertex::absorb_removeVertex_retainEdge(Edge *e)
         neighbour = e->toVertex();
     else
         neighbour = e->fromVertex();
-    absorbed.append(neighbour);
-    absorbed.append(neighbour->getAbsorbedList());
+    spliceChain(ABSORBED_CHAIN, neighbour);
     neighbour->setParent(this);
 }
 
 // SELF
 void Vertex::absorb_retainEdge()
 {
-    absorbed.append(this);
+    spliceChain(ABSORBED_CHAIN, this);
     this->setParent(this);
 }
 
@@ -374,8 +397,7 @@ void Vertex::absorb_retainEdge(Edge *e)
     else
         neighbour = e->fromVertex();
 
-    absorbed.append(neighbour);
-    absorbed.append(neighbour->getAbsorbedList());
+    spliceChain(ABSORBED_CHAIN, neighbour);
     neighbour->setParent(this);
 }
 
@@ -392,19 +414,28 @@ void Vertex::absorb_retainEdge_setParentPointer(Edge *e)
     else
         neighbour = e->fromVertex();
 
-    absorbed.append(neighbour);
-    absorbed.append(neighbour->getAbsorbedList());
+    spliceChain(ABSORBED_CHAIN, neighbour);
     neighbour->setParentPointerOnly(this);
 }
 
 void Vertex::absorb_singleton(Vertex *v)
 {
-    absorbed.append(v->getAbsorbedList());
-    absorbed.append(v);
+    spliceChain(ABSORBED_CHAIN, v);
     v->setParent(this);
     v->remove_all_edges();
 }
 
+/** Fold v into this vertex before the aggregation starts (pendant trees and
+ * degree-2 chains, see Graph::fold_pendants_and_chains); v stops playing
+ * @brief Vertex::absorb_dragged_along
+ * @param v
+ */
+void Vertex::absorb_dragged_along(Vertex *v)
+{
+    absorb_singleton(v);
+    v->isDraggedAlong = true;
+}
+
 Vertex *Vertex::get_neighbour_fromEdge(quint32 edge_index)
 {
     Vertex * neighbour = 0;
@@ -433,6 +464,8 @@ Vertex *Vertex::get_neighbour_fromEdge(Edge *edge)
 
 Edge *Vertex::getHighestDegreeNeighbour()
 {
+    if (myNeighbourKey == DEGREE_KEY && myNeighbourQueue != 0 && !myNeighbourQueue->empty())
+        return myTrackedEdge.at(myNeighbourQueue->randomMax(myRng));
     QList<Edge*> edge;
     Edge * final;
     quint32 highest = 0;
@@ -454,8 +487,7 @@ Edge *Vertex::getHighestDegreeNeighbour()
     }
     if (edge.size() > 1)
     {
-        std::uniform_int_distribution<int> distribution(0,edge.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(edge.size());
         final = edge.at(ran);
     }
     else
@@ -471,32 +503,57 @@ Edge *Vertex::getHighestDegreeNeighbour()
 void Vertex::getKMostMutualNeighbours(QList<Edge *> &max, const int k)
 {
     //get the triangluation with all neighbours
-    QMap<int, Edge*> neighbourMap;
+    std::vector<std::pair<quint64, quint32> > scratch;
+    scratch.reserve(myEdge.size());
     for (int i = 0; i < myEdge.size(); i++)
     {
         Vertex * neighbour = this->get_neighbour_fromEdge(myEdge[i]);
-
-     //   if (neighbour->getParent() == this)
-     //       continue;
-
         quint64 numTriangle = this->getNoOfTriangles(neighbour);
-        if (neighbourMap.contains(numTriangle))   neighbourMap.insertMulti(numTriangle, myEdge[i]);
-        else    neighbourMap.insert(numTriangle, myEdge[i]);
+        scratch.push_back(std::make_pair((numTriangle << 32) | myRng.next32(), (quint32) i));
     }
-    QList<int> keys = neighbourMap.keys();
-    //sort num of mutual triangles
-    qSort(keys.begin(), keys.end(), qGreater<int>());
-    int numEdgeReturned = 0;
-    for (int i = 0; i < keys.size(); i++)
+    selectKMostMutual(max, k, scratch);
+}
+
+/** As above with the number of mutual neighbours read from precomputed edge
+ * support (indexed by Edge::getIndex()). scratch is reused between calls.
+ * Only this vertex's stream is used, so distinct vertices may run concurrently
+ * @brief Vertex::getKMostMutualNeighbours
+ * @param max
+ * @param k
+ * @param support
+ * @param scratch
+ */
+void Vertex::getKMostMutualNeighbours(QList<Edge *> &max, const int k, const std::vector<quint32> &support,
+                                      std::vector<std::pair<quint64, quint32> > &scratch)
+{
+    scratch.clear();
+    for (int i = 0; i < myEdge.size(); i++)
     {
-        QList<Edge*> edgeList = neighbourMap.values(keys[i]);
-        for( int j = 0; j < edgeList.size(); j++)
-        {
-            if (numEdgeReturned == k)   break;
-            max.append(edgeList[j]);
-            numEdgeReturned++;
-        }
+        quint64 numTriangle = support[myEdge[i]->getIndex()];
+        scratch.push_back(std::make_pair((numTriangle << 32) | myRng.next32(), (quint32) i));
     }
+    selectKMostMutual(max, k, scratch);
+}
+
+/** Append the k edges of highest key, highest first. Keys are the number of
+ * triangles in the upper half and a random word in the lower half, so ties
+ * at the k-th place are broken uniformly at random. O(d + k log k)
+ * @brief Vertex::selectKMostMutual
+ * @param max
+ * @param k
+ * @param scratch (key, position in myEdge)
+ */
+void Vertex::selectKMostMutual(QList<Edge *> &max, const int k, std::vector<std::pair<quint64, quint32> > &scratch)
+{
+    if (k <= 0 || scratch.empty())
+        return;
+    std::vector<std::pair<quint64, quint32> >::iterator kth = scratch.begin() + qMin((size_t) k, scratch.size());
+    std::greater<std::pair<quint64, quint32> > higher;
+    if (kth != scratch.end())
+        std::nth_element(scratch.begin(), kth, scratch.end(), higher);
+    std::sort(scratch.begin(), kth, higher);
+    for (std::vector<std::pair<quint64, quint32> >::iterator it = scratch.begin(); it != kth; ++it)
+        max.append(myEdge[it->second]);
 }
 
 
@@ -505,6 +562,70 @@ QList<Edge *> Vertex::getAllEdge() const
     return myEdge;
 }
 
+/** Keep the incident edges in a bucket queue keyed by the neighbour's current
+ * degree (or weight) so the min/max neighbour selectors do not scan myEdge.
+ * Every vertex of the graph has to track the same key: a vertex notifies its
+ * neighbours whenever its own key changes
+ * @brief Vertex::trackNeighbours
+ * @param key DEGREE_KEY or WEIGHT_KEY
+ */
+void Vertex::trackNeighbours(const int &key)
+{
+    untrackNeighbours();
+    if (key == NO_KEY)
+        return;
+    myNeighbourKey = key;
+    myTrackedEdge = myEdge;
+    myNeighbourQueue = new BucketQueue(myTrackedEdge.size());
+    for (int i = 0; i < myTrackedEdge.size(); i++)
+    {
+        Edge * e = myTrackedEdge.at(i);
+        Vertex * neighbour = get_neighbour_fromEdge(e);
+        e->setSlot(this, i);
+        if (key == DEGREE_KEY)
+            myNeighbourQueue->insert(i, neighbour->getNumberEdge());
+        else
+            myNeighbourQueue->insert(i, neighbour->getWeight());
+    }
+}
+
+void Vertex::untrackNeighbours()
+{
+    myNeighbourKey = NO_KEY;
+    if (myNeighbourQueue != 0)
+    {
+        delete myNeighbourQueue;
+        myNeighbourQueue = 0;
+    }
+    myTrackedEdge.clear();
+}
+
+/** The neighbour across e has a new key
+ * @brief Vertex::updateNeighbourKey
+ * @param e
+ * @param key
+ */
+void Vertex::updateNeighbourKey(Edge *e, const quint64 &key)
+{
+    if (myNeighbourQueue == 0)
+        return;
+    quint32 slot = e->getSlot(this);
+    if (myNeighbourQueue->contains(slot))
+        myNeighbourQueue->update(slot, key);
+}
+
+void Vertex::notifyNeighbours()
+{
+    if (myNotifySuspended)
+        return;
+    quint64 key = (myNeighbourKey == DEGREE_KEY) ? myEdge.size() : myWeight;
+    for (int i = 0; i < myEdge.size(); i++)
+    {
+        Edge * e = myEdge.at(i);
+        get_neighbour_fromEdge(e)->updateNeighbourKey(e, key);
+    }
+}
+
 Edge *Vertex::getEdge(quint32 edgeIndex) const
 {
     return myEdge.at(edgeIndex);
@@ -525,8 +646,7 @@ Edge *Vertex::getWeightedProbabilisticEdge()
         for (quint64 j = 0; j < w; j++)
             edge.append(e);
     }
-    std::uniform_int_distribution<quint64> distribution(0,edge.size()-1);
-    quint64 ran = distribution(gen);
+    quint64 ran = myRng.bounded(edge.size());
     return edge.at(ran);
 }
 
@@ -536,19 +656,56 @@ Edge *Vertex::getWeightedProbabilisticEdge()
  */
 Edge *Vertex::getDegreeProbabilisticEdge()
 {
-    QList<Edge*> edge;
+    //degrees only go down while no edge is added, so the max neighbour degree
+    //seen by the last scan bounds every current neighbour degree: removals are
+    //ignored on purpose, a stale upper bound only costs rejected trials
+    if (myEdge.empty() || myBoundVersion != edgeAdditions || myNeighbourDegreeBound == 0)
+        return getDegreeProbabilisticEdgeByScan();
+    //uniform neighbour, accepted with probability d(u)/bound: expected trials d*bound/sum d(u)
+    for (int trial = 0; trial < 16; trial++)
+    {
+        Edge * e = myEdge.at(myRng.bounded(myEdge.size()));
+        quint32 w = get_neighbour_fromEdge(e)->getNumberEdge();
+        if (myRng.bounded(myNeighbourDegreeBound) < w)
+            return e;
+    }
+    //bound has drifted too far from the current degrees: exact draw, which also tightens it
+    return getDegreeProbabilisticEdgeByScan();
+}
+
+/** Exact O(d) draw by walking the cumulative neighbour degrees, refreshes the bound
+ * @brief Vertex::getDegreeProbabilisticEdgeByScan
+ * @return
+ */
+Edge *Vertex::getDegreeProbabilisticEdgeByScan()
+{
+    quint64 total = 0;
+    quint32 highest = 0;
+    for (int i = 0; i < myEdge.size(); i++)
+    {
+        quint32 w = get_neighbour_fromEdge(myEdge.at(i))->getNumberEdge();
+        total += w;
+        highest = qMax(highest, w);
+    }
+    //rejection takes d * bound / total trials against the d neighbours of a scan,
+    //keep the bound only where that saves a clear factor
+    myNeighbourDegreeBound = (REJECTION_GAIN * (quint64) highest <= total) ? highest : 0;
+    myBoundVersion = edgeAdditions;
+    if (total == 0)
+    {
+        qDebug() << "NO NEIGHBOUR TO DRAW FROM!";
+        return 0;
+    }
+    quint64 ran = myRng.bounded64(total);
     for (int i = 0; i < myEdge.size(); i++)
     {
         Edge * e = myEdge.at(i);
-        Vertex * v = get_neighbour_fromEdge(e);
-        quint32 w = v->getNumberEdge();
-        for (quint32 j = 0; j < w; j++)
-            edge.append(e);
+        quint32 w = get_neighbour_fromEdge(e)->getNumberEdge();
+        if (ran < w)
+            return e;
+        ran -= w;
     }
-
-    std::uniform_int_distribution<quint32> distribution(0,edge.size()-1);
-    quint32 ran = distribution(gen);
-    return edge.at(ran);
+    return myEdge.last();
 }
 
 
@@ -567,8 +724,7 @@ Vertex *Vertex::aggregate_get_degree_biased_neighbour()
         for (quint64 j = 0; j < weight; j++)
             neighbours.append(neighbour);
     }
-    std::uniform_int_distribution<quint64> distribution(0,neighbours.size()-1);
-    quint64 ran = distribution(gen);
+    quint64 ran = myRng.bounded(neighbours.size());
     return neighbours.at(ran);
 }
 
@@ -621,18 +777,19 @@ Edge * Vertex::getMostMutualVertex()
     }
     if (candidate.empty())
     {
-        std::uniform_int_distribution<int> distribution(0,myEdge.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(myEdge.size());
         return myEdge.at(ran);
     }
     else if (candidate.size() > 1)
     {
-        std::uniform_int_distribution<int> distribution(0,candidate.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(candidate.size());
         return candidate.at(ran);
     }
     else
         return candidate.at(0);*/
+    //no triangle at all: every edge ties at 0, same draw as below
+    if (is_triangle_free())
+        return myEdge.size() > 1 ? myEdge.at(myRng.bounded(myEdge.size())) : myEdge.at(0);
     QList<Edge*> ran_list;
     quint32 highest = 0;
     for (int i = 0; i < myEdge.size(); i++)
@@ -642,7 +799,7 @@ Edge * Vertex::getMostMutualVertex()
      //   if (neighbour->getParent() == this)
      //       continue;
 
-        quint64 similar = this->getNoOfTriangles(neighbour);
+        quint64 similar = neighbour->is_triangle_free() ? 0 : this->getNoOfTriangles(neighbour);
         if (similar > highest)
         {
             highest = similar;
@@ -656,14 +813,12 @@ Edge * Vertex::getMostMutualVertex()
     }
     if (ran_list.empty())
     {
-        std::uniform_int_distribution<int> distribution(0,myEdge.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(myEdge.size());
         return myEdge.at(ran);
     }
     else if (ran_list.size() > 1)
     {
-        std::uniform_int_distribution<int> distribution(0,ran_list.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(ran_list.size());
         return ran_list.at(ran);
     }
     else
@@ -674,117 +829,69 @@ Edge * Vertex::getMostMutualVertex()
 
 
 /** Get the Highest Triangulate Cluster
+ * score(C) = triangles on the first edge into C + neighbours of this in C
+ * (the adjacent vertex and the centroid excluded): O(d) per call
  * @brief Vertex::getHighestTriangulateCluster
+ * @param clusters union-find over the current clusters, labelled by centroid
+ * @param support triangles per edge index
  * @return
  */
 
-Edge *Vertex::getHighestTriangulateCluster()
+Edge *Vertex::getHighestTriangulateCluster(DisjointSet &clusters, const std::vector<quint32> &support)
 {
-    //first get all neighbour cluster
-    QList<Vertex*> centroids;
-    QList<quint32> queried_edge;
-    for (quint32 i = 0; i < myEdge.size(); i++)
+    //group the incident edges by neighbouring cluster, keeping the first edge of each
+    QHash<quint32, int> group;
+    QList<int> first_edge;
+    QList<quint32> members;
+    QList<bool> centroid_adjacent;
+    for (int i = 0; i < myEdge.size(); i++)
     {
-        Edge * e = myEdge.at(i);
-        Vertex * neighbour = this->get_neighbour_fromEdge(e);
-        //get the neighbour cluster
-        Vertex * par = neighbour->getParent();
-        QList<Vertex*> tree;
-        while (par != 0)
-        {
-            neighbour = par;
-            if (tree.contains(neighbour))
-                break;
-            else
-                tree.append(neighbour);
-            par = neighbour->getParent();
-        }
-        if (centroids.contains(neighbour))
-            continue;
-        else
+        Vertex * neighbour = this->get_neighbour_fromEdge(myEdge.at(i));
+        quint32 root = clusters.find(neighbour->getIndex());
+        int g = group.value(root, -1);
+        if (g == -1)
         {
-                centroids.append(neighbour);
-                queried_edge.append(i);
+            g = first_edge.size();
+            group.insert(root, g);
+            first_edge.append(i);
+            members.append(0);
+            centroid_adjacent.append(false);
         }
-
+        members[g]++;
+        if (clusters.getLabel(root) == neighbour->getIndex())
+            centroid_adjacent[g] = true;
     }
 
-    quint64 highest_score = 0;
-    QList<quint32> index;
-
-    for (quint32 i = 0 ; i < queried_edge.size(); i++)
+    qint64 highest_score = 0;
+    QList<int> index;
+    for (int g = 0; g < first_edge.size(); g++)
     {
-        quint32 edge_index = queried_edge.at(i);
-        Edge * e = myEdge.at(edge_index);
+        Edge * e = myEdge.at(first_edge[g]);
         Vertex * adjacent = this->get_neighbour_fromEdge(e);
-
-        Vertex * queried_centroid = centroids[i];
-        quint32 score = 0;
-        // count number of real triangles between V and This
-        QList<quint32> current_iteration_neighbour = adjacent->getNeighbourIndexes();
-        //get current centroid indexes
-        QList<Vertex*> current_iteration_cluster = queried_centroid->getMyCluster();
-        QList<quint32> current_iteration_cluster_indexes;
-        for (quint32 j = 0; j < current_iteration_cluster.size(); j++ )
+        quint32 centroid = clusters.getLabel(adjacent->getIndex());
+        // real triangles on e, then the other neighbours of this inside the cluster (centroid excluded)
+        qint64 score = support[e->getIndex()];
+        score += members[g] - 1;
+        if (centroid_adjacent[g] && centroid != adjacent->getIndex())
+            score--;
+        if (centroid == myIndex)
+            score -= clusters.getSize(myIndex) - 1;
+        if (index.empty() || score > highest_score)
         {
-            Vertex * v = current_iteration_cluster.at(j);
-            current_iteration_cluster_indexes.append(v->getIndex());
-
-        }
-
-        //counting score
-        for (quint32 j = 0; j < myNeighbours.size(); j++)
-        {
-            quint32 adj = myNeighbours[j];
-            if (adj == adjacent->getIndex())
-                continue;
-            if (current_iteration_neighbour.contains(adj))
-            {
-                score++;
-            }
-            if (current_iteration_cluster_indexes.contains(adj))
-            {
-                score++;
-            }
-        }
-
-        if (queried_centroid->getIndex() == this->getIndex())
-            score -= myCluster.size();
-        if (score < highest_score)
-        {
-            if (index.size() == 0)
-            {
-                highest_score = score;
-                index.append(edge_index);
-            }
+            highest_score = score;
+            index.clear();
+            index.append(first_edge[g]);
         }
         else if (score == highest_score)
         {
-            index.append(edge_index);
-        }
-        else if (score > highest_score)
-        {
-            highest_score = score;
-            index.clear();
-            index.append(edge_index);
+            index.append(first_edge[g]);
         }
     }
 
-
-    quint32 selected_index = 0;
+    int selected_index = index.at(0);
     if (index.size() > 1)
-    {
-        std::uniform_int_distribution<int> distribution(0,index.size()-1);
-        int ran = distribution(gen);
-        selected_index = index.at(ran);
-    }
-    else
-    {
-        selected_index = index.at(0);
-    }
-
-    Edge * final = myEdge.at(selected_index);
-    return final;
+        selected_index = index.at(myRng.bounded(index.size()));
+    return myEdge.at(selected_index);
 }
 
 
@@ -796,11 +903,14 @@ Edge *Vertex::getHighestTriangulateCluster()
 
 Edge *Vertex::getProbabilisticTriangulationCoeffVertex()
 {
+    //no triangle at all: every edge is sampled once, i.e. uniformly
+    if (is_triangle_free())
+        return myEdge.at(myRng.bounded(myEdge.size()));
     QList<Edge*> sample;
     for (quint32 i = 0; i < myEdge.size(); i++)
     {
         Vertex * neighbour = this->get_neighbour_fromEdge(myEdge[i]);
-        quint32 similar = this->getNoOfTriangles(neighbour);
+        quint32 similar = neighbour->is_triangle_free() ? 0 : this->getNoOfTriangles(neighbour);
 
         sample.append(myEdge[i]);
         for (quint32 j =0; j < similar; j++)
@@ -808,14 +918,12 @@ Edge *Vertex::getProbabilisticTriangulationCoeffVertex()
     }
     if(!sample.empty())
     {
-        std::uniform_int_distribution<quint32> distribution(0,sample.size()-1);
-        quint32 ran = distribution(gen);
+        quint32 ran = myRng.bounded(sample.size());
         return sample.at(ran);
     }
     else
     {
-        std::uniform_int_distribution<int> distribution(0,myEdge.size()-1);
-        int ran = distribution(gen);
+        int ran = myRng.bounded(myEdge.size());
         return myEdge.at(ran);
     }
 }
@@ -832,11 +940,14 @@ Edge *Vertex::getProbabilisticTriangulationAndWeightVertex()
     QList<Edge*> sample;
     if (this->getNumberEdge() == 1)
         return myEdge.at(0);
+    //no triangle at all: every f(u) is 0
+    if (is_triangle_free())
+        return 0;
 
     for (int i = 0; i < myEdge.size(); i++)
     {
         Vertex * neighbour = this->get_neighbour_fromEdge(myEdge[i]);
-        quint32 similar = this->getNoOfTriangles(neighbour);
+        quint32 similar = neighbour->is_triangle_free() ? 0 : this->getNoOfTriangles(neighbour);
         quint64 normalise_w = 0;
         if (neighbour->getNoChild() > 0)
             normalise_w = neighbour->getExtraWeight() / neighbour->getNoChild();
@@ -846,11 +957,7 @@ Edge *Vertex::getProbabilisticTriangulationAndWeightVertex()
     }
     if (sample.size() == 0)
         return 0;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    gen.seed(QTime::currentTime().msec());
-    std::uniform_int_distribution<quint64> distribution(0, sample.size() - 1);
-    quint64 ran = distribution(gen);
+    quint64 ran = myRng.bounded(sample.size());
     return sample.at(ran);
 }
 
@@ -867,16 +974,16 @@ quint32 Vertex::getNoOfTriangles(Vertex *v)
 
 QList<Vertex *> Vertex::getMyCluster()
 {
-    return myCluster;
+    return chainMembers(CLUSTER_CHAIN);
 }
 
 
 void Vertex::addMemberToCluster(Vertex *v)
 {
-    if (myCluster.contains(v))
+    if (v->myLinked[CLUSTER_CHAIN])
         qDebug() << "ERR: MEMBER ALREADY IN CLUSTER";
     else
-        myCluster.append(v);
+        spliceChain(CLUSTER_CHAIN, v);
 }
 
 
@@ -884,23 +991,99 @@ void Vertex::addMemberToCluster(QList<Vertex *> v)
 {
     if (v.size() == 0)
         return;
-    for (quint32 i = 0; i < v.size(); i++)
+    for (int i = 0; i < v.size(); i++)
     {
-        if (!myCluster.contains(v[i]))
-            myCluster.append(v[i]);
+        if (!v[i]->myLinked[CLUSTER_CHAIN])
+            spliceChain(CLUSTER_CHAIN, v[i]);
     }
 }
 
 
 void Vertex::clearCluster()
 {
-    myCluster.clear();
+    clearChain(CLUSTER_CHAIN);
 }
 
 
 void Vertex::clearAbsorbed()
 {
-    absorbed.clear();
+    clearChain(ABSORBED_CHAIN);
+}
+
+/** Move v, then every member v holds, to the end of chain c of this.
+ * A vertex sits in at most one chain of each kind: if v is already linked
+ * somewhere only its members move. O(1)
+ * @brief Vertex::spliceChain
+ * @param c ABSORBED_CHAIN or CLUSTER_CHAIN
+ * @param v
+ */
+void Vertex::spliceChain(const int &c, Vertex *v)
+{
+    MemberChain &mine = myChain[c];
+    MemberChain &theirs = v->myChain[c];
+    MemberChain moved;
+    moved.head = theirs.head;
+    moved.tail = theirs.tail;
+    moved.count = theirs.count;
+    theirs.head = theirs.tail = 0;
+    theirs.count = 0;
+    if (!v->myLinked[c])
+    {
+        v->myLinked[c] = true;
+        v->myNext[c] = moved.head;
+        if (moved.tail == 0)
+            moved.tail = v;
+        moved.head = v;
+        moved.count++;
+    }
+    if (moved.count == 0)
+        return;
+    if (mine.tail == 0)
+        mine.head = moved.head;
+    else
+        mine.tail->myNext[c] = moved.head;
+    mine.tail = moved.tail;
+    mine.count += moved.count;
+}
+
+/** Enumerate chain c, done once when results are parsed
+ * @brief Vertex::chainMembers
+ * @param c
+ * @return
+ */
+QList<Vertex *> Vertex::chainMembers(const int &c) const
+{
+    QList<Vertex*> members;
+    members.reserve(myChain[c].count);
+    for (Vertex * v = myChain[c].head; v != 0 && members.size() < (int) myChain[c].count; v = v->myNext[c])
+        members.append(v);
+    return members;
+}
+
+void Vertex::clearChain(const int &c)
+{
+    Vertex * v = myChain[c].head;
+    for (quint32 i = 0; v != 0 && i < myChain[c].count; i++)
+    {
+        Vertex * next = v->myNext[c];
+        v->myNext[c] = 0;
+        v->myLinked[c] = false;
+        v = next;
+    }
+    myChain[c].head = myChain[c].tail = 0;
+    myChain[c].count = 0;
+}
+
+/** Forget chain c and this vertex's own link, used when every vertex is reset together
+ * @brief Vertex::resetChain
+ * @param c
+ */
+void Vertex::resetChain(const int &c)
+{
+    myChain[c].head = myChain[c].tail = 0;
+    myChain[c].count = 0;
+    myNext[c] = 0;
+    myLinked[c] = false;
 }
 
 void Vertex::setTruthCommunity(const int &p)
@@ -920,14 +1103,16 @@ int Vertex::getTruthCommunity() const
 
 void Vertex::resetClusterRelevant()
 {
-    myCluster.clear();
-    absorbed.clear();
+    resetChain(ABSORBED_CHAIN);
+    resetChain(CLUSTER_CHAIN);
     myWeight = 1;
     parent = 0;
     isDraggedAlong = false;
     isAbsorbed = false;
     noOfChild = 0;
     ExtraWeight = 0;
+    myRng = Rng::stream(myIndex);
+    untrackNeighbours();
     myNeighbours.clear();
     if (myEdge.size() > 0)
     {
@@ -936,6 +1121,51 @@ void Vertex::resetClusterRelevant()
     myEdge.clear();
 }
 
+/** Number of edges ever attached to any vertex, changes whenever a graph gains edges
+ * @brief Vertex::getEdgeAdditions
+ * @return
+ */
+quint64 Vertex::getEdgeAdditions()
+{
+    return edgeAdditions;
+}
+
+/** Number of edge ends ever detached from any vertex, changes whenever a graph
+ * loses edges (destructive rules, folding, clear_edge)
+ * @brief Vertex::getEdgeRemovals
+ * @return
+ */
+quint64 Vertex::getEdgeRemovals()
+{
+    return edgeRemovals;
+}
+
+/** Core number cached by Graph::count_core_numbers, UNKNOWN_CORE to forget it.
+ * Removing edges can only lower a core number, so a cached value stays an
+ * upper bound while the vertices are being absorbed
+ * @brief Vertex::setCoreNumber
+ * @param k
+ */
+void Vertex::setCoreNumber(const quint32 &k)
+{
+    myCore = k;
+}
+
+quint32 Vertex::getCoreNumber() const
+{
+    return myCore;
+}
+
+/** A vertex of core number 0 or 1 is in no triangle: the three corners of a
+ * triangle all lie in the 2-core
+ * @brief Vertex::is_triangle_free
+ * @return true if the cached core number is known and at most 1
+ */
+bool Vertex::is_triangle_free() const
+{
+    return myCore <= 1;
+}
+
 /** Count the number of Colin's Triangles i.e. number of pair of neighbours that have a triangle
  * @brief Vertex::getNumberOfColinTriangles
  * @return
@@ -2,13 +2,34 @@
 #define VERTEX_H
 
 #include <QSet>
+#include <QHash>
+#include <vector>
 #include <QDebug>
 
 #include "edge.h"
+#include "rng.h"
+#include "bucketqueue.h"
+#include "disjointset.h"
+
+class Vertex;
+
+/** Intrusive singly linked list of member vertices: the links live in the
+ * members themselves, so merging two lists is an O(1) splice
+ */
+struct MemberChain
+{
+    Vertex * head;
+    Vertex * tail;
+    quint32 count;
+};
 
 class Vertex
 {
 public:
+    enum NeighbourKey { NO_KEY, DEGREE_KEY, WEIGHT_KEY };
+    enum { UNKNOWN_CORE = 0xFFFFFFFFu };
+    enum Chain { ABSORBED_CHAIN = 0, CLUSTER_CHAIN = 1 };
+
     Vertex();
     ~Vertex();
     void setIndex(const quint32 &number);
@@ -37,21 +58,29 @@ public:
     void absorb_retainEdge(Edge * e);
     void absorb_retainEdge_setParentPointer(Edge * e);
     void absorb_singleton(Vertex * v);
+    void absorb_dragged_along(Vertex * v);
 
     Edge * getEdge(quint32 edgeIndex) const;
     Edge * getWeightedProbabilisticEdge();
     Edge * getDegreeProbabilisticEdge();
+    Edge * getDegreeProbabilisticEdgeByScan();
     Edge * getEdgeFromVertex(Vertex * v2);
     Edge * getSmallestCurrentDegreeNeighbour();
     Edge * getSmallestCurrentWeightNeighbour();
     Edge * getHighestDegreeNeighbour();
     void getKMostMutualNeighbours(QList<Edge*> &max, const int k);
+    void getKMostMutualNeighbours(QList<Edge*> &max, const int k, const std::vector<quint32> &support,
+                                  std::vector<std::pair<quint64, quint32> > &scratch);
     Edge * getMostMutualVertex();
-    Edge * getHighestTriangulateCluster();
+    Edge * getHighestTriangulateCluster(DisjointSet &clusters, const std::vector<quint32> &support);
     Edge * getProbabilisticTriangulationCoeffVertex();
     Edge * getProbabilisticTriangulationAndWeightVertex();
     QList<Edge*> getAllEdge() const;
 
+    void trackNeighbours(const int &key);
+    void untrackNeighbours();
+    void updateNeighbourKey(Edge * e, const quint64 &key);
+
     Vertex * aggregate_get_degree_biased_neighbour();
     Vertex *get_neighbour_fromEdge(quint32 edge_index);
     Vertex *get_neighbour_fromEdge(Edge * e);
@@ -91,15 +120,31 @@ public:
 
     quint32 getNumberOfColinTriangles();
     bool isNeighbour(const quint32 &u);
+    static quint64 getEdgeAdditions();
+    static quint64 getEdgeRemovals();
+
+    void setCoreNumber(const quint32 &k);
+    quint32 getCoreNumber() const;
+    bool is_triangle_free() const;
 private:
+    void notifyNeighbours();
+    void selectKMostMutual(QList<Edge*> &max, const int k, std::vector<std::pair<quint64, quint32> > &scratch);
+    void spliceChain(const int &c, Vertex * v);
+    QList<Vertex*> chainMembers(const int &c) const;
+    void clearChain(const int &c);
+    void resetChain(const int &c);
+
+    static quint64 edgeAdditions;
+    static quint64 edgeRemovals;
 
     Vertex * parent;
     QList<quint32> myNeighbours;
-    QList<Vertex*> absorbed;
+    MemberChain myChain[2];
+    Vertex * myNext[2];
+    bool myLinked[2];
 
 protected:
     QList<Edge *> myEdge;
-    QList<Vertex*> myCluster;
 
     quint32 myIndex;
     quint64 myWeight;
@@ -109,6 +154,14 @@ protected:
     quint64 ExtraWeight;
     quint32 cSize;
     int myRealCommunity;
+    RngStream myRng;
+    int myNeighbourKey;
+    bool myNotifySuspended;
+    BucketQueue * myNeighbourQueue;
+    QList<Edge*> myTrackedEdge;
+    quint32 myNeighbourDegreeBound;
+    quint64 myBoundVersion;
+    quint32 myCore;
 };
 
 #endif // VERTEX_H